@@ -2,64 +2,840 @@
 #include <vector>
 #include <fstream>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <thread>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 using namespace std;
 using namespace chrono;
 
-// Funkcja wypisujaca wszystkie kombinacje do bufora (wektora stringow)
-void saveCombination(const vector<int>& comb, vector<string>& buffer) {
-    string line;
-    for (int num : comb)
-        line += to_string(num) + " ";
-    buffer.push_back(line);
+// Bufor zapisu: liczby formatowane bezposrednio do duzego bloku pamieci,
+// bez to_string i bez alokacji na kazda kombinacje
+class BufferedWriter {
+public:
+    static const size_t BUFFER_SIZE = 1 << 20;
+
+    explicit BufferedWriter(ostream& os) : os(os), buffer(BUFFER_SIZE), pos(0) {}
+    ~BufferedWriter() { flush(); }
+
+    void writeChar(char c) {
+        if (pos == BUFFER_SIZE)
+            flush();
+        buffer[pos++] = c;
+    }
+
+    void writeString(const char* s) {
+        while (*s)
+            writeChar(*s++);
+    }
+
+    void writeUInt(uint64_t value) {
+        char digits[20];
+        int len = 0;
+        do {
+            digits[len++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        if (pos + len > BUFFER_SIZE)
+            flush();
+        while (len > 0)
+            buffer[pos++] = digits[--len];
+    }
+
+    void writeBytes(const unsigned char* data, size_t len) {
+        if (pos + len > BUFFER_SIZE)
+            flush();
+        for (size_t i = 0; i < len; i++)
+            buffer[pos++] = static_cast<char>(data[i]);
+    }
+
+    void flush() {
+        os.write(buffer.data(), pos);
+        pos = 0;
+    }
+
+private:
+    ostream& os;
+    vector<char> buffer;
+    size_t pos;
+};
+
+// Odbiorca kombinacji zapisujacy je tekstowo (liczby oddzielone spacjami)
+struct TextSink {
+    BufferedWriter& out;
+    uint64_t count = 0;
+
+    explicit TextSink(BufferedWriter& out) : out(out) {}
+
+    void operator()(const vector<int>& comb) {
+        for (int num : comb) {
+            out.writeUInt(num);
+            out.writeChar(' ');
+        }
+        out.writeChar('\n');
+        count++;
+    }
+};
+
+// Odbiorca kombinacji, ktory jedynie je zlicza (pomiar samego algorytmu)
+// Suma kontrolna zapobiega usunieciu generowania przez optymalizator
+struct CountingSink {
+    uint64_t count = 0;
+    uint64_t checksum = 0;
+
+    void operator()(const vector<int>& comb) {
+        count++;
+        checksum += comb.back();
+    }
+
+    void operator()(uint64_t mask) {
+        count++;
+        checksum += mask;
+    }
+
+    void operator()(const vector<int>&, int removed, int added) {
+        count++;
+        checksum += removed ^ added;
+    }
+};
+
+// Krok algorytmu klasycznego: przejscie do nastepnej kombinacji (false gdy koniec)
+inline bool nextCombination(vector<int>& comb, int n) {
+    int k = static_cast<int>(comb.size());
+    int i = k - 1;
+    while (i >= 0 && comb[i] == n - k + i + 1)
+        i--;
+    if (i < 0) return false;
+    comb[i]++;
+    for (int j = i + 1; j < k; j++)
+        comb[j] = comb[i] + (j - i);
+    return true;
+}
+
+// Krok algorytmu Semby: przejscie do nastepnej kombinacji (false gdy koniec)
+inline bool nextCombinationSemby(vector<int>& comb, int n) {
+    int k = static_cast<int>(comb.size());
+    int i = k - 1;
+    while (i >= 0 && (comb[i] - (i + 1)) == (n - k))
+        i--;
+    if (i < 0) return false;
+    comb[i]++;
+    for (int j = i + 1; j < k; j++)
+        comb[j] = comb[j - 1] + 1;
+    return true;
 }
 
 // Funkcja generujaca wszystkie kombinacje wg algorytmu klasycznego
-void generateCombinations(int n, int k, vector<string>& buffer) {
+// Kazda kombinacja jest przekazywana do odbiorcy (sink) - pamiec nie rosnie z liczba kombinacji
+template <typename Sink>
+void generateCombinations(int n, int k, Sink& sink) {
     vector<int> comb(k);
     for (int i = 0; i < k; i++)
         comb[i] = i + 1;
 
-    saveCombination(comb, buffer);
-
-    while (true) {
-        int i = k - 1;
-        while (i >= 0 && comb[i] == n - k + i + 1)
-            i--;
-        if (i < 0) break;
-        comb[i]++;
-        for (int j = i + 1; j < k; j++)
-            comb[j] = comb[i] + (j - i);
-        saveCombination(comb, buffer);
-    }
+    do {
+        sink(comb);
+    } while (nextCombination(comb, n));
 }
 
 // Funkcja generująca kombinacje wg algorytmu Semby
-void generateCombinationsSemby(int n, int k, vector<string>& buffer) {
+template <typename Sink>
+void generateCombinationsSemby(int n, int k, Sink& sink) {
     vector<int> comb(k);
     for (int i = 0; i < k; i++)
         comb[i] = i + 1;
 
-    saveCombination(comb, buffer);
+    do {
+        sink(comb);
+    } while (nextCombinationSemby(comb, n));
+}
+
+// Funkcja generujaca kombinacje w porzadku "drzwi obrotowych" (Knuth, algorytm R):
+// kolejne kombinacje roznia sie dokladnie jednym elementem - jeden wychodzi, jeden wchodzi.
+// Odbiorca dostaje kombinacje oraz zmiane (out, in); dla pierwszej kombinacji out = in = 0.
+// Krok wykonuje zamortyzowanie O(1) operacji, wiec odbiorca zapisujacy tylko zmiane placi O(1).
+template <typename DeltaSink>
+void generateCombinationsRevolving(int n, int k, DeltaSink& sink) {
+    // c[j - 1] odpowiada c_j z opisu algorytmu, wartosci 1..n; c_{k+1} = n + 1 (straznik)
+    vector<int> c(k);
+    for (int j = 0; j < k; j++)
+        c[j] = j + 1;
+    auto at = [&](int j) { return j > k ? n + 1 : c[j - 1]; };
 
+    sink(c, 0, 0);
     while (true) {
-        int i = k - 1;
-        while (i >= 0 && (comb[i] - (i + 1)) == (n - k))
-            i--;
-        if (i < 0) break;
-        comb[i]++;
-        for (int j = i + 1; j < k; j++)
-            comb[j] = comb[j - 1] + 1;
-        saveCombination(comb, buffer);
+        int out = 0, in = 0;
+        // Przypadek prosty: zmiana najmniejszego elementu
+        if (k % 2 == 1 && c[0] + 1 < at(2)) {
+            out = c[0];
+            in = ++c[0];
+            sink(c, out, in);
+            continue;
+        }
+        if (k % 2 == 0 && c[0] > 1) {
+            out = c[0];
+            in = --c[0];
+            sink(c, out, in);
+            continue;
+        }
+
+        // Na zmiane: proba zmniejszenia c_j (gdy j + k nieparzyste, wtedy c_j = c_{j-1} + 1)
+        // i proba zwiekszenia c_j (gdy j + k parzyste, wtedy c_{j-1} = j - 1)
+        bool moved = false;
+        for (int j = 2; j <= k && !moved; j++) {
+            if ((j + k) % 2 == 1) {
+                if (c[j - 1] >= j + 1) {
+                    out = c[j - 1];
+                    in = j - 1;
+                    c[j - 1] = c[j - 2];
+                    c[j - 2] = j - 1;
+                    moved = true;
+                }
+            }
+            else if (c[j - 1] + 1 < at(j + 1)) {
+                out = c[j - 2];
+                c[j - 2] = c[j - 1];
+                in = ++c[j - 1];
+                moved = true;
+            }
+        }
+        if (!moved)
+            return;
+        sink(c, out, in);
+    }
+}
+
+// Adapter pomijajacy zmiane (out, in) - przekazuje pelna kombinacje dalej
+template <typename Sink>
+struct IgnoreDeltaSink {
+    Sink& inner;
+    uint64_t count = 0;
+
+    explicit IgnoreDeltaSink(Sink& inner) : inner(inner) {}
+
+    void operator()(const vector<int>& comb, int, int) {
+        inner(comb);
+        count++;
+    }
+};
+
+// Odbiorca zapisujacy pierwsza kombinacje w calosci, a dalej tylko zmiany "-out +in"
+struct DeltaTextSink {
+    BufferedWriter& out;
+    uint64_t count = 0;
+
+    explicit DeltaTextSink(BufferedWriter& out) : out(out) {}
+
+    void operator()(const vector<int>& comb, int removed, int added) {
+        if (count++ == 0) {
+            for (int num : comb) {
+                out.writeUInt(num);
+                out.writeChar(' ');
+            }
+        }
+        else {
+            out.writeChar('-');
+            out.writeUInt(removed);
+            out.writeString(" +");
+            out.writeUInt(added);
+        }
+        out.writeChar('\n');
+    }
+};
+
+// Indeks najmlodszego ustawionego bitu (x != 0)
+inline int lowestBitIndex(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+// Maska z k najmlodszymi bitami ustawionymi (0 <= k <= 64)
+inline uint64_t lowMask(int k) {
+    return k >= 64 ? ~0ULL : (1ULL << k) - 1;
+}
+
+// Krok algorytmu Gospera: nastepna liczba o tej samej liczbie jedynek (bez rozgalezien)
+inline uint64_t nextMask(uint64_t x) {
+    uint64_t t = x | (x - 1);
+    return (t + 1) | (((~t & (t + 1)) - 1) >> (lowestBitIndex(x) + 1));
+}
+
+// Funkcja generujaca kombinacje jako maski bitowe (n <= 64), bit i oznacza element i + 1
+// Maski rosna numerycznie, wiec kombinacje pojawiaja sie w porzadku kolesykograficznym
+template <typename MaskSink>
+void generateCombinationsGosper(int n, int k, MaskSink& sink) {
+    uint64_t mask = lowMask(k);
+    uint64_t last = mask << (n - k);
+    sink(mask);
+    while (mask != last) {
+        mask = nextMask(mask);
+        sink(mask);
     }
 }
 
+// Odbiorca masek zapisujacy je bez dekodowania (jako liczby dziesietne)
+struct MaskTextSink {
+    BufferedWriter& out;
+    uint64_t count = 0;
+
+    explicit MaskTextSink(BufferedWriter& out) : out(out) {}
+
+    void operator()(uint64_t mask) {
+        out.writeUInt(mask);
+        out.writeChar('\n');
+        count++;
+    }
+};
+
+// Adapter dekodujacy maske do listy indeksow i przekazujacy ja dalej
+template <typename Sink>
+struct DecodingSink {
+    Sink& inner;
+    vector<int> comb;
+    uint64_t count = 0;
+
+    explicit DecodingSink(Sink& inner) : inner(inner) {}
+
+    void operator()(uint64_t mask) {
+        comb.clear();
+        while (mask != 0) {
+            comb.push_back(lowestBitIndex(mask) + 1);
+            mask &= mask - 1;
+        }
+        inner(comb);
+        count++;
+    }
+};
+
+// Tablica wspolczynnikow dwumianowych C(i, j) dla i <= n, j <= k (trojkat Pascala)
+// Przechowywane sa tylko kolumny 0..k, bo tylko takie sa odczytywane przy (un)rankingu
+// Wartosci, ktore nie mieszcza sie w uint64_t, sa nasycane do UINT64_MAX
+class BinomialTable {
+public:
+    static const uint64_t SATURATED = numeric_limits<uint64_t>::max();
+
+    BinomialTable(int n, int k)
+        : n(n), k(k), table(static_cast<size_t>(n + 1) * static_cast<size_t>(k + 1), 0) {
+        for (int i = 0; i <= n; i++) {
+            at(i, 0) = 1;
+            for (int j = 1; j <= min(i, k); j++) {
+                uint64_t a = at(i - 1, j - 1), b = at(i - 1, j);
+                at(i, j) = (a > SATURATED - b) ? SATURATED : a + b;
+            }
+        }
+    }
+
+    uint64_t operator()(int i, int j) const {
+        if (i < 0 || j < 0 || j > i) return 0;
+        if (i > n || j > k)
+            throw out_of_range("wspolczynnik dwumianowy poza zakresem tablicy");
+        return table[static_cast<size_t>(i) * (k + 1) + j];
+    }
+
+private:
+    uint64_t& at(int i, int j) { return table[static_cast<size_t>(i) * (k + 1) + j]; }
+
+    int n, k;
+    vector<uint64_t> table;
+};
+
+// Funkcja wyznaczajaca kombinacje o podanym numerze (0..C(n,k)-1) w porzadku leksykograficznym
+// Dziala rowniez dla nasyconych wartosci tablicy: nasycony wspolczynnik jest zawsze wiekszy
+// od numeru, wiec porownania pozostaja poprawne dla kazdego numeru mieszczacego sie w uint64_t
+void unrankCombination(const BinomialTable& binom, int n, int k, uint64_t rank, vector<int>& comb) {
+    if (rank >= binom(n, k))
+        throw out_of_range("numer kombinacji poza zakresem [0, C(n,k))");
+    comb.resize(k);
+    int x = 1;
+    for (int i = 0; i < k; i++) {
+        // Liczba kombinacji zaczynajacych sie (na pozycji i) od elementu x
+        uint64_t c = binom(n - x, k - i - 1);
+        while (rank >= c) {
+            rank -= c;
+            x++;
+            c = binom(n - x, k - i - 1);
+        }
+        comb[i] = x++;
+    }
+}
+
+// Funkcja wyznaczajaca numer kombinacji w porzadku leksykograficznym
+// Rzuca overflow_error, gdy numer nie miesci sie w uint64_t
+uint64_t rankCombination(const BinomialTable& binom, int n, const vector<int>& comb) {
+    int k = static_cast<int>(comb.size());
+    uint64_t rank = 0;
+    int x = 1;
+    for (int i = 0; i < k; i++) {
+        if (comb[i] < x || comb[i] > n - k + i + 1)
+            throw invalid_argument("niepoprawna kombinacja (elementy rosnace z zakresu 1..n)");
+        // Pomijamy wszystkie kombinacje z mniejszym elementem na pozycji i
+        for (; x < comb[i]; x++) {
+            uint64_t c = binom(n - x, k - i - 1);
+            if (c == BinomialTable::SATURATED || rank > BinomialTable::SATURATED - 1 - c)
+                throw overflow_error("numer kombinacji nie miesci sie w 64 bitach");
+            rank += c;
+        }
+        x++;
+    }
+    return rank;
+}
+
+// Funkcja odpowiadajaca na zapytania z pliku, kazda linia to jedno zapytanie:
+//   unrank <numer>        - kombinacja o podanym numerze
+//   rank <a1> ... <ak>    - numer podanej kombinacji
+void answerQueries(int n, int k, istream& queries, BufferedWriter& out) {
+    BinomialTable binom(n, k);
+    vector<int> comb;
+    string line;
+    int lineNo = 0;
+    while (getline(queries, line)) {
+        lineNo++;
+        istringstream ls(line);
+        string type;
+        if (!(ls >> type))
+            continue;
+        try {
+            if (type == "unrank") {
+                uint64_t rank;
+                if (!(ls >> rank))
+                    throw invalid_argument("brak numeru kombinacji");
+                unrankCombination(binom, n, k, rank, comb);
+                for (int num : comb) {
+                    out.writeUInt(num);
+                    out.writeChar(' ');
+                }
+                out.writeChar('\n');
+            }
+            else if (type == "rank") {
+                comb.clear();
+                int num;
+                while (ls >> num)
+                    comb.push_back(num);
+                if (static_cast<int>(comb.size()) != k)
+                    throw invalid_argument("kombinacja musi miec k elementow");
+                out.writeUInt(rankCombination(binom, n, comb));
+                out.writeChar('\n');
+            }
+            else {
+                throw invalid_argument("nieznany typ zapytania: " + type);
+            }
+        }
+        catch (const exception& ex) {
+            cerr << "Błąd (linia " << lineNo << "): " << ex.what() << "\n";
+            out.writeString("BLAD\n");
+        }
+    }
+}
+
+typedef bool (*StepFunction)(vector<int>&, int);
+
+// Funkcja generujaca count kombinacji poczawszy od kombinacji o numerze first
+template <typename Sink>
+void generateRange(const BinomialTable& binom, int n, int k, uint64_t first, uint64_t count,
+    StepFunction step, Sink& sink) {
+    if (count == 0) return;
+    vector<int> comb;
+    unrankCombination(binom, n, k, first, comb);
+    sink(comb);
+    for (uint64_t i = 1; i < count && step(comb, n); i++)
+        sink(comb);
+}
+
+// Funkcja generujaca kombinacje rownolegle: zakres numerow [0, C(n,k)) dzielony jest
+// na fragmenty, kazdy watek zapisuje swoj fragment do osobnego pliku czesciowego,
+// a pliki sa nastepnie sklejane w kolejnosci - wynik jest identyczny jak w trybie sekwencyjnym
+uint64_t generateParallel(int n, int k, StepFunction step, unsigned threads, const string& prefix) {
+    BinomialTable binom(n, k);
+    uint64_t total = binom(n, k);
+    if (total == BinomialTable::SATURATED)
+        throw overflow_error("C(n,k) nie miesci sie w 64 bitach");
+
+    uint64_t chunks = static_cast<uint64_t>(threads) * 4;
+    if (chunks > total) chunks = total;
+    uint64_t chunkSize = (total + chunks - 1) / chunks;
+    chunks = (total + chunkSize - 1) / chunkSize;
+
+    atomic<uint64_t> nextChunk(0);
+    atomic<bool> failed(false);
+    auto worker = [&]() {
+        for (uint64_t c = nextChunk++; c < chunks; c = nextChunk++) {
+            ofstream part(prefix + to_string(c) + ".tmp", ios::binary);
+            if (!part) {
+                failed = true;
+                return;
+            }
+            BufferedWriter out(part);
+            TextSink sink(out);
+            uint64_t first = c * chunkSize;
+            uint64_t count = min(chunkSize, total - first);
+            generateRange(binom, n, k, first, count, step, sink);
+        }
+    };
+
+    vector<thread> pool;
+    for (unsigned t = 0; t < threads; t++)
+        pool.emplace_back(worker);
+    for (auto& th : pool)
+        th.join();
+    if (failed)
+        throw runtime_error("nie mozna utworzyc pliku czesciowego");
+    return chunks;
+}
+
+// Funkcja doklejajaca pliki czesciowe (w kolejnosci) do pliku wynikowego i usuwajaca je
+void mergeParts(ostream& os, const string& prefix, uint64_t chunks) {
+    for (uint64_t c = 0; c < chunks; c++) {
+        string name = prefix + to_string(c) + ".tmp";
+        {
+            ifstream part(name, ios::binary);
+            if (part.peek() != ifstream::traits_type::eof())
+                os << part.rdbuf();
+        }
+        remove(name.c_str());
+    }
+}
+
+// Format binarny kombinacji (wszystkie pola little-endian):
+//   naglowek 24 B: "CMB1" | n (u16) | k (u16) | algorytm (u8) | rozmiar elementu (u8) |
+//                  zarezerwowane (6 B) | liczba kombinacji (u64)
+//   rekordy: k elementow o stalym rozmiarze (u8 dla n <= 255, u16 dla wiekszych n)
+// Kombinacja o numerze i zaczyna sie od bajtu HEADER_SIZE + i * k * rozmiar_elementu,
+// wiec plik mozna mapowac do pamieci i czytac dowolny rekord bez przegladania poprzednich
+enum Algorithm : uint8_t { ALG_CLASSICAL = 0, ALG_SEMBA = 1, ALG_GOSPER = 2 };
+
+struct BinaryHeader {
+    static const size_t HEADER_SIZE = 24;
+
+    uint16_t n = 0;
+    uint16_t k = 0;
+    uint8_t algorithm = ALG_CLASSICAL;
+    uint8_t elementSize = 1;
+    uint64_t count = 0;
+
+    void encode(unsigned char* bytes) const {
+        memset(bytes, 0, HEADER_SIZE);
+        memcpy(bytes, "CMB1", 4);
+        bytes[4] = static_cast<unsigned char>(n & 0xFF);
+        bytes[5] = static_cast<unsigned char>(n >> 8);
+        bytes[6] = static_cast<unsigned char>(k & 0xFF);
+        bytes[7] = static_cast<unsigned char>(k >> 8);
+        bytes[8] = algorithm;
+        bytes[9] = elementSize;
+        for (int i = 0; i < 8; i++)
+            bytes[16 + i] = static_cast<unsigned char>(count >> (8 * i));
+    }
+
+    bool decode(const unsigned char* bytes) {
+        if (memcmp(bytes, "CMB1", 4) != 0)
+            return false;
+        n = static_cast<uint16_t>(bytes[4] | (bytes[5] << 8));
+        k = static_cast<uint16_t>(bytes[6] | (bytes[7] << 8));
+        algorithm = bytes[8];
+        elementSize = bytes[9];
+        count = 0;
+        for (int i = 0; i < 8; i++)
+            count |= static_cast<uint64_t>(bytes[16 + i]) << (8 * i);
+        return (elementSize == 1 || elementSize == 2) && k > 0 && k <= n;
+    }
+};
+
+// Odbiorca kombinacji zapisujacy je jako rekordy o stalej dlugosci
+struct BinarySink {
+    BufferedWriter& out;
+    int elementSize;
+    vector<unsigned char> record;
+    uint64_t count = 0;
+
+    BinarySink(BufferedWriter& out, int elementSize) : out(out), elementSize(elementSize) {}
+
+    void operator()(const vector<int>& comb) {
+        record.resize(comb.size() * elementSize);
+        for (size_t i = 0; i < comb.size(); i++) {
+            record[i * elementSize] = static_cast<unsigned char>(comb[i] & 0xFF);
+            if (elementSize == 2)
+                record[i * elementSize + 1] = static_cast<unsigned char>(comb[i] >> 8);
+        }
+        out.writeBytes(record.data(), record.size());
+        count++;
+    }
+};
+
+// Funkcja zapisujaca wszystkie kombinacje wybranym algorytmem do pliku binarnego
+// Liczba kombinacji w naglowku jest uzupelniana po zakonczeniu generowania
+uint64_t writeBinary(ofstream& ofs, int n, int k, Algorithm algorithm) {
+    BinaryHeader header;
+    header.n = static_cast<uint16_t>(n);
+    header.k = static_cast<uint16_t>(k);
+    header.algorithm = algorithm;
+    header.elementSize = n <= 255 ? 1 : 2;
+
+    unsigned char bytes[BinaryHeader::HEADER_SIZE];
+    header.encode(bytes);
+    ofs.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+
+    BufferedWriter out(ofs);
+    BinarySink sink(out, header.elementSize);
+    if (algorithm == ALG_CLASSICAL) {
+        generateCombinations(n, k, sink);
+    }
+    else if (algorithm == ALG_SEMBA) {
+        generateCombinationsSemby(n, k, sink);
+    }
+    else {
+        DecodingSink<BinarySink> gosperSink(sink);
+        generateCombinationsGosper(n, k, gosperSink);
+    }
+    out.flush();
+
+    header.count = sink.count;
+    header.encode(bytes);
+    ofs.seekp(0);
+    ofs.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    return sink.count;
+}
+
+// Funkcja odczytujaca plik binarny i zapisujaca kombinacje w postaci tekstowej
+void decodeBinary(istream& is, BufferedWriter& out) {
+    unsigned char bytes[BinaryHeader::HEADER_SIZE];
+    BinaryHeader header;
+    if (!is.read(reinterpret_cast<char*>(bytes), sizeof(bytes)) || !header.decode(bytes))
+        throw runtime_error("niepoprawny naglowek pliku binarnego");
+
+    vector<unsigned char> record(header.k * header.elementSize);
+    for (uint64_t i = 0; i < header.count; i++) {
+        if (!is.read(reinterpret_cast<char*>(record.data()), record.size()))
+            throw runtime_error("plik binarny jest niekompletny");
+        for (int j = 0; j < header.k; j++) {
+            unsigned value = record[j * header.elementSize];
+            if (header.elementSize == 2)
+                value |= record[j * header.elementSize + 1] << 8;
+            out.writeUInt(value);
+            out.writeChar(' ');
+        }
+        out.writeChar('\n');
+    }
+}
+
+// Wyniki pomiarow jednego algorytmu dla jednej pary (n, k)
+struct BenchResult {
+    double minUs;
+    double medianUs;
+    double p95Us;
+    uint64_t count;
+};
+
+// Zapis sumy kontrolnej do zmiennej volatile - wynik pomiarow musi byc "uzyty"
+volatile uint64_t benchmarkGuard = 0;
+
+// Funkcja mierzaca algorytm: rozgrzewka, a nastepnie seria powtorzen
+// Pomiar obejmuje wylacznie generowanie (odbiorca zliczajacy, bez zapisu i alokacji)
+template <typename Generator>
+BenchResult benchmark(Generator generate, int warmups, int repetitions) {
+    uint64_t checksum = 0;
+    for (int i = 0; i < warmups; i++) {
+        CountingSink sink;
+        generate(sink);
+        checksum += sink.checksum;
+    }
+
+    vector<double> samples;
+    uint64_t count = 0;
+    for (int i = 0; i < repetitions; i++) {
+        CountingSink sink;
+        auto start = steady_clock::now();
+        generate(sink);
+        auto end = steady_clock::now();
+        samples.push_back(duration<double, micro>(end - start).count());
+        count = sink.count;
+        checksum += sink.checksum;
+    }
+    benchmarkGuard = checksum;
+
+    sort(samples.begin(), samples.end());
+    size_t p95 = (samples.size() * 95 + 99) / 100;
+    BenchResult result;
+    result.minUs = samples.front();
+    result.medianUs = samples.size() % 2 == 1 ? samples[samples.size() / 2]
+        : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+    result.p95Us = samples[p95 > 0 ? p95 - 1 : 0];
+    result.count = count;
+    return result;
+}
+
+// Funkcja wykonujaca pomiary dla siatki par (n, k) i zapisujaca wyniki w formacie CSV
+void runBenchmarks(const vector<pair<int, int>>& grid, int warmups, int repetitions, ostream& csv) {
+    csv << "algorytm,n,k,kombinacje,min_us,mediana_us,p95_us,kombinacje_na_s\n";
+    for (const auto& nk : grid) {
+        int n = nk.first, k = nk.second;
+        vector<pair<string, BenchResult>> results;
+        results.emplace_back("klasyczny", benchmark([&](CountingSink& s) { generateCombinations(n, k, s); },
+            warmups, repetitions));
+        results.emplace_back("semba", benchmark([&](CountingSink& s) { generateCombinationsSemby(n, k, s); },
+            warmups, repetitions));
+        results.emplace_back("obrotowe", benchmark([&](CountingSink& s) { generateCombinationsRevolving(n, k, s); },
+            warmups, repetitions));
+        if (n <= 64)
+            results.emplace_back("gosper", benchmark([&](CountingSink& s) { generateCombinationsGosper(n, k, s); },
+                warmups, repetitions));
+
+        for (const auto& r : results) {
+            const BenchResult& b = r.second;
+            double perSecond = b.medianUs > 0 ? b.count / (b.medianUs / 1e6) : 0.0;
+            csv << r.first << ',' << n << ',' << k << ',' << b.count << ','
+                << b.minUs << ',' << b.medianUs << ',' << b.p95Us << ',' << perSecond << '\n';
+            cout << r.first << " n=" << n << " k=" << k << ": mediana " << b.medianUs
+                << " us, p95 " << b.p95Us << " us, " << perSecond << " kombinacji/s\n";
+        }
+    }
+}
+
+// Funkcja wczytujaca siatke par (n, k) z pliku (kazda linia: n k)
+vector<pair<int, int>> readGrid(istream& is) {
+    vector<pair<int, int>> grid;
+    int n, k;
+    while (is >> n >> k) {
+        if (n > 0 && k > 0 && k <= n)
+            grid.emplace_back(n, k);
+    }
+    return grid;
+}
+
 // Funkcja sprawdzająca poprawność danych wejściowych
 bool validateInput(int n, int k) {
     return (n > 0 && k > 0 && k <= n);
 }
 
-int main() {
+// Funkcja mierzaca czas samego algorytmu: generowanie do CountingSink,
+// bez formatowania i zapisu do pliku (te odbywaja sie w osobnym przebiegu poza pomiarem)
+template <typename Generate>
+CountingSink timedGeneration(Generate generate, long long& us) {
+    CountingSink sink;
+    auto start = high_resolution_clock::now();
+    generate(sink);
+    auto end = high_resolution_clock::now();
+    us = duration_cast<microseconds>(end - start).count();
+    benchmarkGuard = sink.checksum;
+    return sink;
+}
+
+// Funkcja wypisujaca czas wykonania na ekran i do pliku
+void reportTime(BufferedWriter& out, const char* label, long long us, uint64_t count) {
+    cout << label << us << " us (" << count << " kombinacji)\n";
+    out.writeString(label);
+    out.writeUInt(static_cast<uint64_t>(us));
+    out.writeString(" us\n");
+}
+
+int main(int argc, char* argv[]) {
+    // Tryb rownolegly: Lab1 --parallel [liczba_watkow]
+    // Surowe maski algorytmu Gospera: Lab1 --masks
+    // Same zmiany (-out +in) w porzadku drzwi obrotowych: Lab1 --delta
+    // Zapytania rank/unrank z pliku: Lab1 --query plik
+    // Zapis binarny do output.bin: Lab1 --binary [klasyczny|semba|gosper]
+    // Odczyt pliku binarnego do output.txt: Lab1 --decode plik.bin
+    // Pomiary wydajnosci do pliku CSV: Lab1 --bench [wyniki.csv] [--grid plik] [--reps liczba]
+    bool parallel = false;
+    bool bench = false;
+    string benchFile = "bench.csv";
+    string gridFile;
+    int repetitions = 15;
+    bool rawMasks = false;
+    bool deltaOnly = false;
+    bool binary = false;
+    Algorithm binaryAlgorithm = ALG_CLASSICAL;
+    string queryFile;
+    string decodeFile;
+    unsigned threads = thread::hardware_concurrency();
+    // Niepoprawne wartosci liczbowe (stoi/stoul/stoull) zglaszaja wyjatki
+    try {
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            if (arg == "--parallel") {
+                parallel = true;
+                if (i + 1 < argc && argv[i + 1][0] != '-')
+                    threads = static_cast<unsigned>(stoul(argv[++i]));
+            }
+            else if (arg == "--masks") {
+                rawMasks = true;
+            }
+            else if (arg == "--delta") {
+                deltaOnly = true;
+            }
+            else if (arg == "--query" && i + 1 < argc) {
+                queryFile = argv[++i];
+            }
+            else if (arg == "--binary") {
+                binary = true;
+                if (i + 1 < argc && argv[i + 1][0] != '-') {
+                    string name = argv[++i];
+                    if (name == "klasyczny") binaryAlgorithm = ALG_CLASSICAL;
+                    else if (name == "semba") binaryAlgorithm = ALG_SEMBA;
+                    else if (name == "gosper") binaryAlgorithm = ALG_GOSPER;
+                    else {
+                        cerr << "Błąd: nieznany algorytm " << name << "\n";
+                        return 1;
+                    }
+                }
+            }
+            else if (arg == "--decode" && i + 1 < argc) {
+                decodeFile = argv[++i];
+            }
+            else if (arg == "--bench") {
+                bench = true;
+                if (i + 1 < argc && argv[i + 1][0] != '-')
+                    benchFile = argv[++i];
+            }
+            else if (arg == "--grid" && i + 1 < argc) {
+                gridFile = argv[++i];
+            }
+            else if (arg == "--reps" && i + 1 < argc) {
+                repetitions = max(1, stoi(argv[++i]));
+            }
+            else {
+                cerr << "Błąd: nieznana opcja " << arg << "\n";
+                return 1;
+            }
+        }
+    }
+    catch (const logic_error&) {
+        cerr << "Błąd: niepoprawna wartosc liczbowa w argumentach wywolania\n";
+        return 1;
+    }
+    if (threads == 0) threads = 1;
+
+    if (!decodeFile.empty()) {
+        ifstream bin(decodeFile, ios::binary);
+        ofstream txt("output.txt");
+        if (!bin || !txt) {
+            cerr << "Błąd: nie można otworzyć pliku " << decodeFile << " lub output.txt\n";
+            return 1;
+        }
+        try {
+            BufferedWriter out(txt);
+            decodeBinary(bin, out);
+        }
+        catch (const exception& ex) {
+            cerr << "Błąd: " << ex.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
     ifstream ifs("input.txt");
     if (!ifs) {
         cerr << "Błąd: nie można otworzyć pliku input.txt\n";
@@ -78,43 +854,139 @@ int main() {
         return 1;
     }
 
+    if (bench) {
+        // Domyslna siatka: podane n i kilka wartosci k az do podanego k
+        vector<pair<int, int>> grid;
+        if (!gridFile.empty()) {
+            ifstream gs(gridFile);
+            grid = readGrid(gs);
+        }
+        else {
+            int step = max(1, k / 4);
+            for (int kk = step; kk < k; kk += step)
+                grid.emplace_back(n, kk);
+            grid.emplace_back(n, k);
+        }
+        if (grid.empty()) {
+            cerr << "Błąd: pusta siatka pomiarow\n";
+            return 1;
+        }
+        ofstream csv(benchFile);
+        if (!csv) {
+            cerr << "Błąd: nie można otworzyć pliku " << benchFile << "\n";
+            return 1;
+        }
+        runBenchmarks(grid, 3, repetitions, csv);
+        return 0;
+    }
+
+    if (binary) {
+        if (n > 65535 || (binaryAlgorithm == ALG_GOSPER && n > 64)) {
+            cerr << "Błąd: n poza zakresem formatu binarnego lub algorytmu Gospera\n";
+            return 1;
+        }
+        ofstream bin("output.bin", ios::binary);
+        if (!bin) {
+            cerr << "Błąd: nie można otworzyć pliku output.bin\n";
+            return 1;
+        }
+        auto start = high_resolution_clock::now();
+        uint64_t count = writeBinary(bin, n, k, binaryAlgorithm);
+        auto end = high_resolution_clock::now();
+        cout << "Zapisano " << count << " kombinacji do output.bin w "
+            << duration_cast<microseconds>(end - start).count() << " us\n";
+        return 0;
+    }
+
     ofstream ofs("output.txt");
     if (!ofs) {
         cerr << "Błąd: nie można otworzyć pliku output.txt\n";
         return 1;
     }
 
-    vector<string> classicalBuffer;
-    vector<string> sembaBuffer;
+    if (!queryFile.empty()) {
+        ifstream queries(queryFile);
+        if (!queries) {
+            cerr << "Błąd: nie można otworzyć pliku " << queryFile << "\n";
+            return 1;
+        }
+        BufferedWriter out(ofs);
+        answerQueries(n, k, queries, out);
+        return 0;
+    }
 
-    auto start = high_resolution_clock::now();
-    generateCombinations(n, k, classicalBuffer);
-    auto end = high_resolution_clock::now();
-    cout << "Czas wykonania klasycznego algorytmu: "
-        << duration_cast<microseconds>(end - start).count()
-        << " us\n";
-    ofs << "Czas wykonania klasycznego algorytmu: "
-        << duration_cast<microseconds>(end - start).count()
-        << " us\n";
-
-    start = high_resolution_clock::now();
-    generateCombinationsSemby(n, k, sembaBuffer);
-    end = high_resolution_clock::now();
-    cout << "Czas wykonania algorytmu Semby: "
-        << duration_cast<microseconds>(end - start).count()
-        << " us\n";
-    ofs << "Czas wykonania algorytmu Semby: "
-        << duration_cast<microseconds>(end - start).count()
-        << " us\n";
-
-    ofs << "\nKombinacje klasyczne\n";
-    for (const auto& line : classicalBuffer)
-        ofs << line << "\n";
-
-    ofs << "Kombinacje Semby\n";
-    for (const auto& line : sembaBuffer)
-        ofs << line << "\n";
+    if (parallel) {
+        try {
+            const StepFunction steps[] = { nextCombination, nextCombinationSemby };
+            const char* headers[] = { "Kombinacje klasyczne\n", "\nKombinacje Semby\n" };
+            const char* labels[] = { "Czas wykonania klasycznego algorytmu (",
+                "Czas wykonania algorytmu Semby (" };
+            for (int a = 0; a < 2; a++) {
+                ofs << headers[a];
+                auto start = high_resolution_clock::now();
+                uint64_t chunks = generateParallel(n, k, steps[a], threads, "output.part");
+                auto end = high_resolution_clock::now();
+                mergeParts(ofs, "output.part", chunks);
+
+                long long us = duration_cast<microseconds>(end - start).count();
+                cout << labels[a] << threads << " watkow): " << us << " us\n";
+                ofs << labels[a] << threads << " watkow): " << us << " us\n";
+            }
+        }
+        catch (const exception& ex) {
+            cerr << "Błąd: " << ex.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    BufferedWriter out(ofs);
+
+    // Kombinacje sa strumieniowane do pliku w osobnym przebiegu; czas dotyczy
+    // przebiegu do CountingSink, wiec nie obejmuje formatowania ani zapisu do pliku
+    long long us;
+    out.writeString("Kombinacje klasyczne\n");
+    TextSink classicalSink(out);
+    generateCombinations(n, k, classicalSink);
+    CountingSink counted = timedGeneration([&](CountingSink& sink) { generateCombinations(n, k, sink); }, us);
+    reportTime(out, "Czas wykonania klasycznego algorytmu: ", us, counted.count);
+
+    out.writeString("\nKombinacje Semby\n");
+    TextSink sembaSink(out);
+    generateCombinationsSemby(n, k, sembaSink);
+    counted = timedGeneration([&](CountingSink& sink) { generateCombinationsSemby(n, k, sink); }, us);
+    reportTime(out, "Czas wykonania algorytmu Semby: ", us, counted.count);
+
+    out.writeString("\nKombinacje drzwi obrotowych\n");
+    if (deltaOnly) {
+        DeltaTextSink deltaSink(out);
+        generateCombinationsRevolving(n, k, deltaSink);
+    }
+    else {
+        TextSink textSink(out);
+        IgnoreDeltaSink<TextSink> revolvingSink(textSink);
+        generateCombinationsRevolving(n, k, revolvingSink);
+    }
+    counted = timedGeneration([&](CountingSink& sink) { generateCombinationsRevolving(n, k, sink); }, us);
+    reportTime(out, "Czas wykonania algorytmu drzwi obrotowych: ", us, counted.count);
+
+    // Algorytm Gospera dziala na masce 64-bitowej, wiec wymaga n <= 64
+    if (n <= 64) {
+        out.writeString("\nKombinacje Gospera\n");
+        if (rawMasks) {
+            MaskTextSink maskSink(out);
+            generateCombinationsGosper(n, k, maskSink);
+        }
+        else {
+            TextSink textSink(out);
+            DecodingSink<TextSink> gosperSink(textSink);
+            generateCombinationsGosper(n, k, gosperSink);
+        }
+        counted = timedGeneration([&](CountingSink& sink) { generateCombinationsGosper(n, k, sink); }, us);
+        reportTime(out, "Czas wykonania algorytmu Gospera: ", us, counted.count);
+    }
 
+    out.flush();
     ofs.close();
     return 0;
 }
@@ -4,41 +4,543 @@
 #include <vector>         // Kontener vector do przechowywania danych
 #include <chrono>         // Pomiar czasu wykonania programu
 #include <algorithm>      // Funkcje min i max do ograniczania zakresów
-#include <unordered_set>  // Kontener do sprawdzania unikalności grup
+#include <cstdint>        // Typy całkowite o stałym rozmiarze (uint64_t)
+#include <string>         // Obsługa argumentów wiersza poleceń
+#include <sstream>        // Bufory wyników poszczególnych zadań (ostringstream)
+#include <thread>         // Wątki robocze
+#include <mutex>          // Blokady licznika zadań i wyników
+#include <condition_variable> // Oczekiwanie na zakończenie kolejnego zadania
+#include <stdexcept>      // Wyjątki zgłaszane przy niepoprawnych zapytaniach
+#include <cmath>          // Logarytmy liczb dokończeń przy losowaniu
+#include <limits>         // Nieskończoność (logarytm zera)
+#include <random>         // Generator liczb losowych z ziarnem
 
 using namespace std;      // Użyj przestrzeni nazw std dla uproszczenia zapisu
 
 int n, k; // Globalne zmienne: n - liczba elementów, k - liczba grup
 
-// Funkcja rekurencyjna generująca wszystkie podziały zbioru na dokładnie k grup
+// Bufor zapisu: dane trafiają do dużego bloku pamięci i są zapisywane do pliku
+// dopiero po jego zapełnieniu (liczby formatowane bez to_string i bez alokacji)
+class BufferedWriter {
+public:
+    static const size_t BUFFER_SIZE = 1 << 20; // Rozmiar bufora: 1 MiB
+
+    explicit BufferedWriter(ostream& os) : os(os), buffer(BUFFER_SIZE), pos(0) {}
+    ~BufferedWriter() { flush(); }
+
+    // Zapisz pojedynczy znak (lub bajt)
+    void writeChar(char c) {
+        if (pos == BUFFER_SIZE)
+            flush();
+        buffer[pos++] = c;
+    }
+
+    // Zapisz liczbę całkowitą w postaci dziesiętnej
+    void writeUInt(uint64_t value) {
+        char digits[20];
+        int len = 0;
+        do {
+            digits[len++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        if (pos + len > BUFFER_SIZE)
+            flush();
+        while (len > 0)
+            buffer[pos++] = digits[--len];
+    }
+
+    // Przekaż zawartość bufora do strumienia
+    void flush() {
+        os.write(buffer.data(), pos);
+        pos = 0;
+    }
+
+private:
+    ostream& os;          // Strumień docelowy
+    vector<char> buffer;  // Blok pamięci na dane
+    size_t pos;           // Liczba zajętych bajtów bufora
+};
+
+// Odbiorca podziałów zapisujący je tekstowo: "numer_grupy_1 numer_grupy_2 ..."
+struct TextSink {
+    BufferedWriter& out;
+    uint64_t count = 0;
+
+    explicit TextSink(BufferedWriter& out) : out(out) {}
+
+    void operator()(const vector<int>& partition) {
+        for (int val : partition) {
+            out.writeUInt(val);
+            out.writeChar(' ');
+        }
+        out.writeChar('\n');
+        count++;
+    }
+};
+
+// Odbiorca podziałów zapisujący je binarnie: jeden bajt (numer grupy) na element,
+// dlatego tryb binarny jest dostępny tylko dla k <= 255
+struct BinarySink {
+    BufferedWriter& out;
+    uint64_t count = 0;
+
+    explicit BinarySink(BufferedWriter& out) : out(out) {}
+
+    void operator()(const vector<int>& partition) {
+        for (int val : partition)
+            out.writeChar(static_cast<char>(val));
+        count++;
+    }
+};
+
+// Funkcja iteracyjna generująca podziały zbioru na co najwyżej k grup
+// (lub na dokładnie k grup, gdy exact == true)
+// Podział jest zapisany jako ciąg o ograniczonym wzroście (restricted growth string):
+// partition[0] = 1, a partition[i] <= max(partition[0..i-1]) + 1 oraz partition[i] <= k.
+// Kolejne podziały powstają z poprzedniego (następnik w porządku leksykograficznym)
+// i są od razu przekazywane do odbiorcy - wyniki nie są przechowywane w pamięci.
+// W trybie exact gałęzie, w których pozostałe elementy nie zdążą otworzyć brakujących
+// grup, nie są w ogóle odwiedzane: końcówka ciągu jest uzupełniana najmniejszym
+// dopuszczalnym dokończeniem (jedynki, a na końcu kolejne nowe grupy).
 // Parametry:
-// - index: aktualny indeks elementu do przypisania do grupy
-// - maxGroup: najwyższy numer grupy użyty dotychczas
 // - n: liczba elementów w zbiorze
-// - k: docelowa liczba grup
-// - partition: aktualny podział (przypisanie elementów do grup)
-// - results: lista wszystkich poprawnych podziałów
-void generatePartitions(int index, int maxGroup, int n, int k,
-    vector<int>& partition, vector<vector<int>>& results) {
-
-    // Warunek zakończenia rekurencji: wszystkie elementy są przypisane
-    if (index == n) {
-        // Bez dodatkowego sprawdzania – dodajemy każdy wygenerowany podział,
-        // który nie przekracza k grup (rekurencja zapewnia to)
-        results.push_back(partition);
-        return;
-    }
-
-    // Próbuj przypisać aktualny element do każdej możliwej grupy
-    // Nowa grupa może być utworzona tylko wtedy, gdy liczba grup nie przekroczy k
-    for (int i = 1; i <= std::min(maxGroup + 1, k); ++i) {
-        partition[index] = i; // Przypisz element do grupy i
-        // Rekurencyjnie generuj podziały dla kolejnego elementu
-        generatePartitions(index + 1, std::max(maxGroup, i), n, k, partition, results);
+// - k: maksymalna (lub dokładna) liczba grup
+// - exact: czy generować tylko podziały na dokładnie k grup
+// - prefix: ustalony początek podziału (poddrzewo); pusty oznacza wszystkie podziały
+// - sink: odbiorca kolejnych podziałów
+template <typename Sink>
+void generatePartitions(int n, int k, bool exact, const vector<int>& prefix, Sink& sink) {
+    vector<int> partition(n);  // Aktualny podział (grupy dla każdego elementu)
+    vector<int> prefixMax(n);  // prefixMax[i] = max(partition[0..i])
+
+    // Pozycje 0..fixed-1 nie są zmieniane (pierwszy element zawsze należy do grupy 1)
+    int fixed = max(1, static_cast<int>(prefix.size()));
+    for (size_t j = 0; j < prefix.size(); ++j) {
+        partition[j] = prefix[j];
+        prefixMax[j] = max(j > 0 ? prefixMax[j - 1] : 0, prefix[j]);
+    }
+
+    // Uzupełnij pozycje od 'from' do końca najmniejszym dopuszczalnym dokończeniem
+    auto fillSuffix = [&](int from) {
+        int current = from > 0 ? prefixMax[from - 1] : 0;
+        for (int j = from; j < n; ++j) {
+            // W trybie exact otwieramy nową grupę, gdy pozostało dokładnie tyle
+            // elementów, ile grup brakuje do k
+            bool openGroup = (j == 0) || (exact && n - j <= k - current);
+            partition[j] = openGroup ? current + 1 : 1;
+            current = max(current, partition[j]);
+            prefixMax[j] = current;
+        }
+    };
+
+    fillSuffix(static_cast<int>(prefix.size())); // Pierwszy podział
+    while (true) {
+        sink(partition);
+
+        // Znajdź ostatnią pozycję, którą można zwiększyć
+        // (zwiększenie nigdy nie zmniejsza liczby grup, więc w trybie exact
+        // każda taka pozycja ma poprawne dokończenie)
+        int i = n - 1;
+        while (i >= fixed && partition[i] >= min(prefixMax[i - 1] + 1, k))
+            i--;
+        if (i < fixed)
+            break; // Ostatni podział został już wygenerowany
+
+        // Zwiększ element i, a kolejne uzupełnij najmniejszym dokończeniem
+        partition[i]++;
+        prefixMax[i] = max(prefixMax[i - 1], partition[i]);
+        fillSuffix(i + 1);
+    }
+}
+
+// Wersja generująca wszystkie podziały (bez ustalonego początku)
+template <typename Sink>
+void generatePartitions(int n, int k, bool exact, Sink& sink) {
+    generatePartitions(n, k, exact, vector<int>(), sink);
+}
+
+// Funkcja generująca podziały wielowątkowo
+// Drzewo przeszukiwania jest dzielone na poddrzewa wyznaczone przez początki podziałów
+// o długości depth. Wątki pobierają kolejne zadania ze wspólnego licznika, a wynik
+// każdego zadania trafia do osobnego bufora. Bufory są zapisywane w kolejności zadań,
+// więc plik wynikowy jest identyczny jak w trybie jednowątkowym. Wątek nie pobiera
+// zadania, które wyprzedza ostatnie zapisane o więcej niż okno zadań, więc w pamięci
+// jest naraz co najwyżej okno buforów (a nie prawie cały wynik).
+uint64_t generatePartitionsParallel(int n, int k, bool exact, bool binary,
+    unsigned threads, int depth, ostream& os) {
+    depth = max(1, min(depth, n));
+    const size_t window = 4 * static_cast<size_t>(threads); // Maksymalne wyprzedzenie zapisu
+
+    // Wyznacz początki podziałów (w porządku leksykograficznym)
+    vector<vector<int>> prefixes;
+    auto collect = [&](const vector<int>& prefix) {
+        int groups = *max_element(prefix.begin(), prefix.end());
+        if (!exact || k - groups <= n - depth) // Pomijaj poddrzewa bez poprawnych podziałów
+            prefixes.push_back(prefix);
+    };
+    generatePartitions(depth, k, false, collect);
+
+    vector<string> buffers(prefixes.size());   // Wyniki poszczególnych zadań
+    vector<uint64_t> counts(prefixes.size(), 0);
+    vector<bool> done(prefixes.size(), false);
+    size_t nextTask = 0;                       // Następne zadanie do pobrania
+    size_t written = 0;                        // Liczba zadań już zapisanych do pliku
+    mutex lock;
+    condition_variable doneSignal;             // Zakończenie zadania (dla wątku zapisującego)
+    condition_variable writtenSignal;          // Postęp zapisu (dla wątków roboczych)
+
+    auto worker = [&]() {
+        // Bufor wątku jest używany ponownie dla kolejnych zadań
+        ostringstream local;
+        BufferedWriter writer(local);
+        while (true) {
+            size_t task;
+            {
+                unique_lock<mutex> guard(lock);
+                writtenSignal.wait(guard, [&] {
+                    return nextTask >= prefixes.size() || nextTask < written + window;
+                });
+                if (nextTask >= prefixes.size())
+                    return;
+                task = nextTask++;
+            }
+
+            uint64_t taskCount;
+            if (binary) {
+                BinarySink sink(writer);
+                generatePartitions(n, k, exact, prefixes[task], sink);
+                taskCount = sink.count;
+            }
+            else {
+                TextSink sink(writer);
+                generatePartitions(n, k, exact, prefixes[task], sink);
+                taskCount = sink.count;
+            }
+            writer.flush();
+
+            lock_guard<mutex> guard(lock);
+            buffers[task] = local.str();
+            counts[task] = taskCount;
+            done[task] = true;
+            doneSignal.notify_one();
+            local.str(string());
+        }
+    };
+
+    vector<thread> pool;
+    for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back(worker);
+
+    // Zapisuj wyniki w kolejności zadań, zwalniając bufory na bieżąco
+    uint64_t total = 0;
+    for (size_t task = 0; task < prefixes.size(); ++task) {
+        string chunk;
+        {
+            unique_lock<mutex> guard(lock);
+            doneSignal.wait(guard, [&] { return done[task]; });
+            chunk.swap(buffers[task]);
+        }
+        os.write(chunk.data(), chunk.size());
+        total += counts[task];
+        {
+            lock_guard<mutex> guard(lock);
+            written = task + 1;
+        }
+        writtenSignal.notify_all();
+    }
+
+    for (auto& th : pool)
+        th.join();
+    return total;
+}
+
+// Liczba całkowita bez znaku o dowolnej precyzji (cyfry o podstawie 2^32, od najmłodszej)
+// Wystarcza do zliczania podziałów: dodawanie, odejmowanie, mnożenie przez małą liczbę
+class BigUInt {
+public:
+    BigUInt(uint64_t value = 0) {
+        while (value > 0) {
+            limbs.push_back(static_cast<uint32_t>(value));
+            value >>= 32;
+        }
+    }
+
+    // Wczytaj liczbę z zapisu dziesiętnego; false, gdy napis nie jest liczbą
+    static bool parse(const string& text, BigUInt& result) {
+        if (text.empty())
+            return false;
+        result = BigUInt();
+        for (char ch : text) {
+            if (ch < '0' || ch > '9')
+                return false;
+            result = result * 10 + BigUInt(static_cast<uint64_t>(ch - '0'));
+        }
+        return true;
+    }
+
+    bool isZero() const { return limbs.empty(); }
+
+    BigUInt& operator+=(const BigUInt& other) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < max(limbs.size(), other.limbs.size()) || carry; ++i) {
+            if (i == limbs.size())
+                limbs.push_back(0);
+            uint64_t sum = carry + limbs[i] + (i < other.limbs.size() ? other.limbs[i] : 0);
+            limbs[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        return *this;
+    }
+
+    // Odejmowanie (wymaga *this >= other)
+    BigUInt& operator-=(const BigUInt& other) {
+        int64_t borrow = 0;
+        for (size_t i = 0; i < limbs.size(); ++i) {
+            int64_t diff = static_cast<int64_t>(limbs[i]) - borrow
+                - (i < other.limbs.size() ? other.limbs[i] : 0);
+            borrow = diff < 0 ? 1 : 0;
+            limbs[i] = static_cast<uint32_t>(diff + (borrow << 32));
+        }
+        trim();
+        return *this;
+    }
+
+    BigUInt operator+(const BigUInt& other) const { BigUInt r = *this; r += other; return r; }
+
+    BigUInt operator*(uint32_t factor) const {
+        BigUInt r;
+        uint64_t carry = 0;
+        for (uint32_t limb : limbs) {
+            uint64_t product = static_cast<uint64_t>(limb) * factor + carry;
+            r.limbs.push_back(static_cast<uint32_t>(product));
+            carry = product >> 32;
+        }
+        if (carry)
+            r.limbs.push_back(static_cast<uint32_t>(carry));
+        r.trim();
+        return r;
     }
+
+    bool operator<(const BigUInt& other) const {
+        if (limbs.size() != other.limbs.size())
+            return limbs.size() < other.limbs.size();
+        for (size_t i = limbs.size(); i-- > 0;)
+            if (limbs[i] != other.limbs[i])
+                return limbs[i] < other.limbs[i];
+        return false;
+    }
+
+    // Zapis dziesiętny (kolejne dzielenie przez 10^9)
+    string toString() const {
+        if (limbs.empty())
+            return "0";
+        vector<uint32_t> rest = limbs;
+        vector<uint32_t> chunks;
+        while (!rest.empty()) {
+            uint64_t remainder = 0;
+            for (size_t i = rest.size(); i-- > 0;) {
+                uint64_t cur = (remainder << 32) | rest[i];
+                rest[i] = static_cast<uint32_t>(cur / 1000000000);
+                remainder = cur % 1000000000;
+            }
+            chunks.push_back(static_cast<uint32_t>(remainder));
+            while (!rest.empty() && rest.back() == 0)
+                rest.pop_back();
+        }
+        string result = to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            string part = to_string(chunks[i]);
+            result += string(9 - part.size(), '0') + part;
+        }
+        return result;
+    }
+
+private:
+    void trim() {
+        while (!limbs.empty() && limbs.back() == 0)
+            limbs.pop_back();
+    }
+
+    vector<uint32_t> limbs; // Cyfry o podstawie 2^32
+};
+
+// Tablica liczb Stirlinga drugiego rodzaju S(i, j) dla i <= n, j <= n
+// wyznaczona metodą programowania dynamicznego: S(i, j) = j * S(i - 1, j) + S(i - 1, j - 1)
+vector<vector<BigUInt>> stirlingTable(int n) {
+    vector<vector<BigUInt>> S(n + 1, vector<BigUInt>(n + 1));
+    S[0][0] = 1;
+    for (int i = 1; i <= n; ++i)
+        for (int j = 1; j <= i; ++j)
+            S[i][j] = S[i - 1][j] * static_cast<uint32_t>(j) + S[i - 1][j - 1];
+    return S;
 }
 
-int main() {
+// Zliczanie, numerowanie (rank) i odtwarzanie (unrank) podziałów bez ich generowania
+// Numeracja zgodna z kolejnością generatePartitions (porządek leksykograficzny ciągów).
+// completions[r][m] = liczba sposobów przypisania r pozostałych elementów, gdy
+// dotychczas użyto m grup (na co najwyżej k grup lub na dokładnie k grup):
+//   completions[0][m] = 1 (lub [m == k] w trybie exact)
+//   completions[r][m] = m * completions[r - 1][m] + completions[r - 1][m + 1] (dla m < k)
+class PartitionCounter {
+public:
+    PartitionCounter(int n, int k, bool exact)
+        : n(n), k(k), completions(n, vector<BigUInt>(k + 2)) {
+        for (int m = 1; m <= k; ++m)
+            completions[0][m] = (!exact || m == k) ? 1 : 0;
+        for (int r = 1; r < n; ++r)
+            for (int m = 1; m <= k; ++m)
+                completions[r][m] = completions[r - 1][m] * static_cast<uint32_t>(m)
+                    + (m < k ? completions[r - 1][m + 1] : BigUInt());
+    }
+
+    // Łączna liczba podziałów (pierwszy element zawsze należy do grupy 1)
+    BigUInt total() const { return completions[n - 1][1]; }
+
+    // Numer podanego podziału (rzuca invalid_argument dla niepoprawnego ciągu)
+    BigUInt rank(const vector<int>& partition) const {
+        if (static_cast<int>(partition.size()) != n || partition[0] != 1)
+            throw invalid_argument("podzial musi miec n elementow i zaczynac sie od 1");
+        BigUInt result;
+        int groups = 1;
+        for (int i = 1; i < n; ++i) {
+            int value = partition[i];
+            if (value < 1 || value > min(groups + 1, k))
+                throw invalid_argument("niepoprawny ciag o ograniczonym wzroscie");
+            // Wszystkie mniejsze wartości na tej pozycji to istniejące grupy
+            const BigUInt& block = completions[n - 1 - i][groups];
+            result += block * static_cast<uint32_t>(value - 1);
+            groups = max(groups, value);
+        }
+        if (completions[0][groups].isZero())
+            throw invalid_argument("podzial nie ma dokladnie k grup");
+        return result;
+    }
+
+    // Podział o podanym numerze (rzuca out_of_range dla numeru spoza zakresu)
+    vector<int> unrank(BigUInt index) const {
+        if (!(index < total()))
+            throw out_of_range("numer podzialu poza zakresem");
+        vector<int> partition(n, 1);
+        int groups = 1;
+        for (int i = 1; i < n; ++i) {
+            const BigUInt& block = completions[n - 1 - i][groups];
+            int value = 1;
+            // Istniejące grupy 1..groups - każda obejmuje 'block' kolejnych numerów
+            while (value <= groups && !(index < block)) {
+                index -= block;
+                value++;
+            }
+            partition[i] = value;
+            groups = max(groups, value);
+        }
+        return partition;
+    }
+
+private:
+    int n, k;
+    vector<vector<BigUInt>> completions;
+};
+
+// Losowanie podziałów z rozkładu jednostajnego bez ich wyliczania
+// Element i trafia do nowej grupy z prawdopodobieństwem równym udziałowi dokończeń,
+// w których otwiera nową grupę, a w przeciwnym razie do losowej istniejącej grupy.
+// Liczby dokończeń (jak w PartitionCounter) są przechowywane jako logarytmy, więc
+// tablica działa również dla n, przy którym liczby Stirlinga przekraczają zakres double.
+class PartitionSampler {
+public:
+    PartitionSampler(int n, int k, bool exact) : n(n), newGroup(n, vector<double>(k + 1, 0.0)) {
+        const double NONE = -numeric_limits<double>::infinity();
+        // logCompletions[r][m] = ln(liczba dokończeń r elementów przy m użytych grupach)
+        vector<vector<double>> logCompletions(n, vector<double>(k + 2, NONE));
+        for (int m = 1; m <= k; ++m)
+            logCompletions[0][m] = (!exact || m == k) ? 0.0 : NONE;
+        for (int r = 1; r < n; ++r) {
+            for (int m = 1; m <= k; ++m) {
+                double existing = log(static_cast<double>(m)) + logCompletions[r - 1][m];
+                double opened = m < k ? logCompletions[r - 1][m + 1] : NONE;
+                double high = max(existing, opened);
+                logCompletions[r][m] = high == NONE ? NONE
+                    : high + log(exp(existing - high) + exp(opened - high));
+            }
+        }
+        // newGroup[r][m] = P(element otwiera nową grupę | po nim zostaje r elementów, użyto m grup)
+        for (int r = 0; r + 1 < n; ++r)
+            for (int m = 1; m <= k; ++m)
+                if (m < k && logCompletions[r + 1][m] != NONE)
+                    newGroup[r][m] = exp(logCompletions[r][m + 1] - logCompletions[r + 1][m]);
+    }
+
+    // Wylosuj jeden podział (wynik zapisywany do partition, bez alokacji)
+    template <typename Rng>
+    void sample(Rng& rng, vector<int>& partition) const {
+        uniform_real_distribution<double> unit(0.0, 1.0);
+        partition.assign(n, 1);
+        int groups = 1;
+        for (int i = 1; i < n; ++i) {
+            if (unit(rng) < newGroup[n - 1 - i][groups]) {
+                partition[i] = ++groups;
+            }
+            else {
+                uniform_int_distribution<int> existing(1, groups);
+                partition[i] = existing(rng);
+            }
+        }
+    }
+
+private:
+    int n;
+    vector<vector<double>> newGroup; // Prawdopodobieństwa otwarcia nowej grupy
+};
+
+int main(int argc, char* argv[]) {
+    // Tryb binarny (Lab2 --binary): podziały trafiają do output.bin (n bajtów na podział),
+    // a output.txt zawiera jedynie podsumowanie
+    // Tryb dokładny (Lab2 --exact): tylko podziały na dokładnie k grup
+    // Tryb wielowątkowy (Lab2 --threads T [--depth d]): podział drzewa na poziomie d
+    // Tryb zliczania (Lab2 --count): S(n, k), liczby Bella, bez generowania
+    // Numer podziału (Lab2 --rank g1 g2 ... gn) i podział o numerze (Lab2 --unrank i)
+    // Losowanie (Lab2 --sample liczba [--seed s]): jednostajnie losowe podziały
+    bool binary = false;
+    bool exact = false;
+    bool countOnly = false;
+    vector<int> rankQuery;
+    string unrankQuery;
+    uint64_t samples = 0;
+    uint64_t seed = 5489;
+    unsigned threads = 1;
+    int depth = 6;
+    // Niepoprawne wartości liczbowe (stoi/stoull) zgłaszają wyjątki
+    try {
+        for (int i = 1; i < argc; ++i) {
+            string arg = argv[i];
+            if (arg == "--binary") binary = true;
+            else if (arg == "--exact") exact = true;
+            else if (arg == "--threads" && i + 1 < argc) threads = max(1, stoi(argv[++i]));
+            else if (arg == "--depth" && i + 1 < argc) depth = stoi(argv[++i]);
+            else if (arg == "--count") countOnly = true;
+            else if (arg == "--sample" && i + 1 < argc) {
+                string value = argv[++i];
+                if (value.empty() || value[0] == '-') // stoull akceptuje "-1" (zawinięcie)
+                    throw invalid_argument(value);
+                samples = stoull(value);
+            }
+            else if (arg == "--seed" && i + 1 < argc) seed = stoull(argv[++i]);
+            else if (arg == "--unrank" && i + 1 < argc) unrankQuery = argv[++i];
+            else if (arg == "--rank") {
+                while (i + 1 < argc && argv[i + 1][0] != '-')
+                    rankQuery.push_back(stoi(argv[++i]));
+            }
+            else {
+                cerr << "Blad: Nieznana opcja " << arg << endl;
+                return 1;
+            }
+        }
+    }
+    catch (const logic_error&) {
+        cerr << "Blad: Niepoprawna wartosc liczbowa w argumentach wywolania!" << endl;
+        return 1;
+    }
+
     // Otwórz plik wejściowy i wczytaj dane
     ifstream inputFile("input.txt");
     if (!inputFile) {
@@ -54,45 +556,128 @@ int main() {
         return 1;
     }
 
-    vector<int> partition(n);     // Aktualny podział (grupy dla każdego elementu)
-    vector<vector<int>> results;  // Lista wszystkich poprawnych podziałów
+    // Numer grupy zapisywany jest w jednym bajcie
+    if (binary && k > 255) {
+        cerr << "Blad: Tryb binarny wymaga k <= 255 (jeden bajt na numer grupy)!" << endl;
+        return 1;
+    }
 
     cout << "Wczytano poprawnie: n = " << n << ", k = " << k << endl;
 
-    // Rozpocznij pomiar czasu generowania podziałów
-    auto start = chrono::high_resolution_clock::now();
-
-    // Wygeneruj wszystkie podziały (rekurencja)
-    generatePartitions(0, 0, n, k, partition, results);
-
-    // Zakończ pomiar czasu
-    auto end = chrono::high_resolution_clock::now();
-
-    // Zapisz wyniki do pliku output.txt
+    // Otwórz plik wyjściowy - podziały są do niego zapisywane w trakcie generowania
     ofstream outputFile("output.txt");
     if (!outputFile) {
         cerr << "Blad: Nie mozna otworzyc pliku wyjsciowego!" << endl;
         return 1;
     }
 
-    // Zapisz każdy podział w formacie: "numer_grupy_1 numer_grupy_2 ..."
-    for (const auto& p : results) {
-        for (int val : p) {
-            outputFile << val << " ";
+    // Tryby analityczne: odpowiedź bez generowania podziałów
+    if (countOnly || !rankQuery.empty() || !unrankQuery.empty()) {
+        auto start = chrono::high_resolution_clock::now();
+        try {
+            if (countOnly) {
+                vector<vector<BigUInt>> S = stirlingTable(n);
+                BigUInt bell, atMostK;
+                for (int j = 1; j <= n; ++j) {
+                    bell += S[n][j];
+                    if (j <= k)
+                        atMostK += S[n][j];
+                }
+                outputFile << "S(" << n << ", " << k << ") = " << S[n][k].toString() << endl;
+                outputFile << "B(" << n << ") = " << bell.toString() << endl;
+                outputFile << "Podzialy na co najwyzej " << k << " grup: " << atMostK.toString() << endl;
+            }
+            PartitionCounter counter(n, k, exact);
+            if (!rankQuery.empty())
+                outputFile << "Numer podzialu: " << counter.rank(rankQuery).toString() << endl;
+            if (!unrankQuery.empty()) {
+                BigUInt index;
+                if (!BigUInt::parse(unrankQuery, index))
+                    throw invalid_argument("niepoprawny numer podzialu: " + unrankQuery);
+                vector<int> partition = counter.unrank(index); // Może zgłosić out_of_range
+                outputFile << "Podzial o numerze " << unrankQuery << ": ";
+                for (int val : partition)
+                    outputFile << val << " ";
+                outputFile << endl;
+            }
         }
-        outputFile << endl; // Nowa linia po każdym podziale
+        catch (const exception& ex) {
+            cerr << "Blad: " << ex.what() << endl;
+            return 1;
+        }
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double, micro> duration = end - start;
+        cout << "Czas obliczen: " << duration.count() << " us" << endl;
+        outputFile << "Czas obliczen: " << duration.count() << " us" << endl;
+        return 0;
     }
 
-    // Oblicz i wypisz czas wykonania w mikrosekundach
+    ofstream binaryFile;
+    if (binary) {
+        binaryFile.open("output.bin", ios::binary);
+        if (!binaryFile) {
+            cerr << "Blad: Nie mozna otworzyc pliku output.bin!" << endl;
+            return 1;
+        }
+    }
+
+    uint64_t count = 0; // Liczba wygenerowanych podziałów
+
+    // Rozpocznij pomiar czasu generowania podziałów (razem z buforowanym zapisem)
+    auto start = chrono::high_resolution_clock::now();
+
+    if (samples > 0) {
+        // Losowanie: liczba podziałów na wyjściu to liczba próbek
+        PartitionSampler sampler(n, k, exact);
+        mt19937_64 rng(seed);
+        vector<int> partition;
+        BufferedWriter writer(binary ? static_cast<ostream&>(binaryFile) : outputFile);
+        TextSink textSink(writer);
+        BinarySink binarySink(writer);
+        for (uint64_t s = 0; s < samples; ++s) {
+            sampler.sample(rng, partition);
+            if (binary) binarySink(partition);
+            else textSink(partition);
+        }
+        count = samples;
+    }
+    else if (threads > 1) {
+        count = generatePartitionsParallel(n, k, exact, binary, threads, depth,
+            binary ? static_cast<ostream&>(binaryFile) : outputFile);
+    }
+    else if (binary) {
+        BufferedWriter writer(binaryFile);
+        BinarySink sink(writer);
+        generatePartitions(n, k, exact, sink);
+        count = sink.count;
+    }
+    else {
+        BufferedWriter writer(outputFile);
+        TextSink sink(writer);
+        generatePartitions(n, k, exact, sink);
+        count = sink.count;
+    }
+
+    // Zakończ pomiar czasu
+    auto end = chrono::high_resolution_clock::now();
+
+    // Oblicz i wypisz czas wykonania w milisekundach
     chrono::duration<double, milli> duration = end - start;
     cout << "Czas wykonania: " << duration.count() << " ms" << endl;
     outputFile << "Czas wykonania: " << duration.count() << " ms" << endl;
 
-    // Wypisz liczbę znalezionych podziałów (liczba Stirlinga drugiego rodzaju)
-    cout << "Laczna liczba wygenerowanych podzialow: " << results.size() << endl;
-    outputFile << "Laczna liczba wygenerowanych podzialow: " << results.size() << endl;
+    // Wypisz liczbę znalezionych podziałów
+    cout << "Laczna liczba wygenerowanych podzialow: " << count << endl;
+    outputFile << "Laczna liczba wygenerowanych podzialow: " << count << endl;
+
+    // W trybie dokładnym wypisz również liczbę Stirlinga drugiego rodzaju S(n, k)
+    if (exact) {
+        string stirling = stirlingTable(n)[n][k].toString();
+        cout << "S(" << n << ", " << k << ") = " << stirling << endl;
+        outputFile << "S(" << n << ", " << k << ") = " << stirling << endl;
+    }
 
     outputFile.close(); // Zamknij plik wyjściowy
 
     return 0;
-}
\ No newline at end of file
+}
@@ -10,17 +10,53 @@
 #include <chrono>        // pomiar czasu
 #include <cmath>         // operacje matematyczne
 #include <string>        // do pracy z tekstem
-#include <map>           // do histogramu
+#include <cstdint>       // typy całkowite o stałym rozmiarze
+#include <memory>        // wybór strategii usuwania powtórzeń
+#include <limits>        // zakres typu uint64_t
+#include <algorithm>     // sortowanie i wybór krawędzi
+#include <stdexcept>     // wyjątki przy niepoprawnych argumentach i braku pamięci
+#include <thread>        // generowanie wielowątkowe
+#include <atomic>        // licznik bloków dla wątków
+#include <mutex>         // synchronizacja stałej puli wątków
+#include <condition_variable>  // budzenie wątków puli
+#include <functional>    // zadanie przekazywane do puli
 
 using namespace std;
 
+// Krawędź grafu skierowanego: (wiersz, kolumna) w macierzy sąsiedztwa
+struct Edge {
+    uint32_t from;
+    uint32_t to;
+};
+
+// Graf w formacie CSR (compressed sparse row):
+// sąsiedzi wierzchołka v to targets[offsets[v] .. offsets[v + 1] - 1]
+struct CSRGraph {
+    vector<uint64_t> offsets;  // N + 1 pozycji
+    vector<uint32_t> targets;  // E pozycji
+};
+
 // Globalne zmienne pobierane z pliku wejściowego
 int K;                  // liczba poziomów podziałów
-int E;                  // liczba krawędzi do wygenerowania
+uint64_t E;             // liczba krawędzi do wygenerowania
 double a, b, c, d;      // prawdopodobieństwa dla ćwiartek: A, B, C, D
 
-int N;                  // liczba wierzchołków = 2^K
-vector<vector<int>> A;  // macierz sąsiedztwa
+uint64_t N;             // liczba wierzchołków = 2^K
+vector<Edge> edges;     // lista krawędzi (bez powtórzeń) - pamięć O(E) zamiast O(N^2)
+vector<uint32_t> out_degree;  // stopnie wyjściowe, aktualizowane przy dodaniu krawędzi
+vector<uint32_t> in_degree;   // stopnie wejściowe, aktualizowane przy dodaniu krawędzi
+
+// Dodanie krawędzi do grafu wraz z aktualizacją liczników stopni
+inline void accept_edge(uint32_t x, uint32_t y) {
+    edges.push_back({ x, y });
+    out_degree[x]++;
+    in_degree[y]++;
+}
+
+// Klucz krawędzi używany do wykrywania powtórzeń
+inline uint64_t edge_key(uint32_t x, uint32_t y) {
+    return (static_cast<uint64_t>(x) << 32) | y;
+}
 
 // Funkcja wczytuje dane wejściowe z pliku
 void read_input(const string& filename) {
@@ -34,95 +70,667 @@ void read_input(const string& filename) {
     infile >> a >> b >> c >> d;  // np. 0.45 0.15 0.15 0.25
     infile.close();
 
+    if (K < 1 || K > 32) {
+        cerr << "Blad: K musi byc z przedzialu [1, 32]" << endl;
+        exit(1);
+    }
+
     // Wyznaczenie liczby wierzchołków: N = 2^K
-    N = 1 << K; // czyli N = 2^K
-    // Inicjalizacja macierzy sąsiedztwa N x N wypełnionej zerami
-    A = vector<vector<int>>(N, vector<int>(N, 0));
+    N = 1ULL << K; // czyli N = 2^K
+    edges.clear();
+    try {
+        out_degree.assign(N, 0);
+        in_degree.assign(N, 0);
+    }
+    catch (const bad_alloc&) {
+        cerr << "Blad: brak pamieci na liczniki stopni dla N = 2^" << K << endl;
+        exit(1);
+    }
+}
+
+// Mieszanie bitów klucza (splitmix64) - równomierny podział kluczy na kubełki
+inline uint64_t mix_key(uint64_t key) {
+    key += 0x9E3779B97F4A7C15ULL;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    return key ^ (key >> 31);
+}
+
+// Funkcja losująca jedną krawędź: K podziałów macierzy na ćwiartki
+// (wersja referencyjna: jedna liczba double i do trzech porównań na poziom)
+template <typename Generator>
+inline void draw_edge(Generator& gen, uniform_real_distribution<double>& dis, uint32_t& x, uint32_t& y) {
+    x = 0;
+    y = 0;
+    // Dokonujemy K podziałów, ustalając dokładne współrzędne krawędzi
+    for (int j = 0; j < K; ++j) {
+        double p = dis(gen);
+        uint32_t bit = 1U << (K - j - 1);
+        if (p < a) {
+            // Ćwiartka A (lewa góra) – brak przesunięcia
+        }
+        else if (p < a + b) {
+            // Ćwiartka B (prawa góra) – przesunięcie w prawo
+            y += bit;
+        }
+        else if (p < a + b + c) {
+            // Ćwiartka C (lewy dół) – przesunięcie w dół
+            x += bit;
+        }
+        else {
+            // Ćwiartka D (prawy dół) – przesunięcie w dół i w prawo
+            x += bit;
+            y += bit;
+        }
+    }
+}
+
+// Progi całkowite wyboru ćwiartki: 16-bitowa liczba losowa p wybiera
+// A gdy p < t[0], B gdy p < t[1], C gdy p < t[2], a w przeciwnym razie D
+struct QuadrantThresholds {
+    uint32_t t[3];
+};
+
+QuadrantThresholds make_thresholds() {
+    const double SCALE = 65536.0;
+    double cumulative[3] = { a, a + b, a + b + c };
+    QuadrantThresholds th;
+    for (int i = 0; i < 3; ++i)
+        th.t[i] = static_cast<uint32_t>(min(SCALE, max(0.0, floor(cumulative[i] * SCALE + 0.5))));
+    return th;
+}
+
+// Funkcja losująca jedną krawędź szybkim jądrem: jedna 64-bitowa liczba losowa
+// wystarcza na 4 poziomy (po 16 bitów), a ćwiartka q = liczba przekroczonych progów
+// (0 = A, 1 = B, 2 = C, 3 = D) wyznacza bity współrzędnych bez rozgałęzień:
+// bit kolumny = q & 1, bit wiersza = q >> 1
+template <typename Generator>
+inline void draw_edge_fast(Generator& gen, const QuadrantThresholds& th, uint32_t& x, uint32_t& y) {
+    x = 0;
+    y = 0;
+    uint64_t word = 0;
+    for (int j = 0; j < K; ++j) {
+        if ((j & 3) == 0)
+            word = gen();
+        uint32_t p = static_cast<uint32_t>(word & 0xFFFF);
+        word >>= 16;
+        uint32_t q = (p >= th.t[0]) + (p >= th.t[1]) + (p >= th.t[2]);
+        x = (x << 1) | (q >> 1);
+        y = (y << 1) | (q & 1);
+    }
+}
+
+// Maksymalna liczba różnych krawędzi, które może wylosować jądro: q^K, gdzie q to liczba
+// ćwiartek o niezerowym prawdopodobieństwie (po zaokrągleniu do progów 16-bitowych).
+// Gdy E przekracza tę wartość (w szczególności E > N^2), ponawianie nigdy by się nie skończyło.
+uint64_t max_reachable_edges() {
+    QuadrantThresholds th = make_thresholds();
+    uint32_t bounds[5] = { 0, th.t[0], th.t[1], th.t[2], 65536 };
+    uint64_t quadrants = 0;
+    for (int i = 0; i < 4; ++i)
+        if (bounds[i + 1] > bounds[i])
+            quadrants++;
+    uint64_t reachable = 1;
+    for (int j = 0; j < K; ++j) {
+        if (reachable > numeric_limits<uint64_t>::max() / quadrants)
+            return numeric_limits<uint64_t>::max();
+        reachable *= quadrants;
+    }
+    return reachable;
+}
+
+// Strategia wykrywania powtórzonych krawędzi
+class EdgeDeduplicator {
+public:
+    virtual ~EdgeDeduplicator() {}
+    // Zwraca true, gdy klucz nie był wcześniej widziany (i zapamiętuje go)
+    virtual bool insert(uint64_t key) = 0;
+};
+
+// Mapa bitowa N x N (N^2 / 8 bajtów) - stały koszt sprawdzenia, dla średnich K
+class BitsetDeduplicator : public EdgeDeduplicator {
+public:
+    BitsetDeduplicator() : bits((N * N + 63) / 64, 0) {}
+
+    bool insert(uint64_t key) override {
+        uint64_t index = (key >> 32) * N + (key & 0xFFFFFFFFULL);
+        uint64_t mask = 1ULL << (index & 63);
+        uint64_t& word = bits[index >> 6];
+        bool fresh = (word & mask) == 0;
+        word |= mask;
+        return fresh;
+    }
+
+private:
+    vector<uint64_t> bits;
+};
+
+// Tablica z adresowaniem otwartym (próbkowanie liniowe) na 64-bitowe klucze krawędzi,
+// wypełniona co najwyżej w połowie - pamięć O(E) niezależnie od K
+class HashDeduplicator : public EdgeDeduplicator {
+public:
+    explicit HashDeduplicator(uint64_t capacity_hint) {
+        // Pojemność (potęga dwójki >= 2 * capacity_hint, czyli najwyżej 4 * capacity_hint)
+        // musi mieścić się w wektorze - sprawdzane przed mnożeniem, które mogłoby się przepełnić
+        if (capacity_hint > slots.max_size() / 4)
+            throw bad_alloc();
+        uint64_t capacity = 16;
+        while (capacity < 2 * capacity_hint)
+            capacity <<= 1;
+        slots.assign(capacity, EMPTY);
+        mask = capacity - 1;
+    }
+
+    bool insert(uint64_t key) override {
+        // Klucz równy znacznikowi pustego miejsca jest pamiętany osobno
+        if (key == EMPTY) {
+            bool fresh = !has_empty_key;
+            has_empty_key = true;
+            return fresh;
+        }
+        for (uint64_t i = mix_key(key) & mask;; i = (i + 1) & mask) {
+            if (slots[i] == key)
+                return false;
+            if (slots[i] == EMPTY) {
+                slots[i] = key;
+                return true;
+            }
+        }
+    }
+
+private:
+    static constexpr uint64_t EMPTY = ~0ULL;
+    vector<uint64_t> slots;
+    uint64_t mask = 0;
+    bool has_empty_key = false;
+};
+
+// Definicja poza klasą: slots.assign(capacity, EMPTY) wiąże EMPTY z referencją (przed C++17 wymagane)
+constexpr uint64_t HashDeduplicator::EMPTY;
+
+// Sposób usuwania powtórzeń w generatorze jednowątkowym
+enum class DedupMode {
+    Auto,    // mapa bitowa, gdy zajmie najwyżej 256 MiB, w przeciwnym razie tablica z haszowaniem
+    Bitset,
+    Hash,
+    Sort     // wsadowo: losowanie brakujących krawędzi, sortowanie i usuwanie powtórzeń
+};
+
+// Funkcja generująca brakujące krawędzie wsadami: każdy wsad jest sortowany razem
+// z pozycjami, powtórzenia (także z już przyjętymi krawędziami) są usuwane, a krawędzie
+// przyjmowane w kolejności losowania - wynik jak przy ponawianiu pojedynczych prób
+template <typename Generator>
+void generate_batches(Generator& gen, const QuadrantThresholds& th) {
+    vector<uint64_t> accepted;  // posortowane klucze przyjętych krawędzi
+    vector<pair<uint64_t, uint64_t>> batch;  // (klucz, pozycja we wsadzie)
+    while (edges.size() < E) {
+        uint64_t missing = E - edges.size();
+        batch.resize(missing);
+        for (uint64_t i = 0; i < missing; ++i) {
+            uint32_t x, y;
+            draw_edge_fast(gen, th, x, y);
+            batch[i] = { edge_key(x, y), i };
+        }
+        sort(batch.begin(), batch.end());
+        batch.erase(unique(batch.begin(), batch.end(),
+            [](const pair<uint64_t, uint64_t>& l, const pair<uint64_t, uint64_t>& r) {
+                return l.first == r.first;
+            }), batch.end());
+        batch.erase(remove_if(batch.begin(), batch.end(),
+            [&](const pair<uint64_t, uint64_t>& p) {
+                return binary_search(accepted.begin(), accepted.end(), p.first);
+            }), batch.end());
+
+        size_t old_size = accepted.size();
+        for (const auto& p : batch)
+            accepted.push_back(p.first);
+        inplace_merge(accepted.begin(), accepted.begin() + old_size, accepted.end());
+
+        sort(batch.begin(), batch.end(),
+            [](const pair<uint64_t, uint64_t>& l, const pair<uint64_t, uint64_t>& r) {
+                return l.second < r.second;
+            });
+        for (const auto& p : batch)
+            accept_edge(static_cast<uint32_t>(p.first >> 32), static_cast<uint32_t>(p.first));
+    }
 }
 
 // Funkcja generująca graf metodą R-MAT
-void generate_RMAT() {
+void generate_RMAT(DedupMode mode) {
     random_device rd;                           // źródło losowości
-    mt19937 gen(rd());                          // generator 
-    uniform_real_distribution<double> dis(0.0, 1.0); // losowa liczba z przedziału [0, 1]
+    mt19937_64 gen((static_cast<uint64_t>(rd()) << 32) | rd()); // generator 
+    QuadrantThresholds th = make_thresholds();  // progi wyboru ćwiartek
+
+    if (mode == DedupMode::Sort) {
+        generate_batches(gen, th);
+        return;
+    }
+
+    // Mapa bitowa tylko dla K <= 15 (N^2 <= 2^30 bitów, w limicie 256 MiB); warunek na K,
+    // bo iloczyn N * N przekracza zakres uint64_t dla K = 32
+    if (mode == DedupMode::Auto)
+        mode = K <= 15 ? DedupMode::Bitset : DedupMode::Hash;
+    unique_ptr<EdgeDeduplicator> seen;          // krawędzie już dodane
+    if (mode == DedupMode::Bitset)
+        seen.reset(new BitsetDeduplicator());
+    else
+        seen.reset(new HashDeduplicator(E));
 
     // Generowanie E krawędzi
-    for (int i = 0; i < E; ++i) {
-        int x = 0, y = 0;
-        // Dokonujemy K podziałów, ustalając dokładne współrzędne krawędzi
-        for (int j = 0; j < K; ++j) {
-            double p = dis(gen);
-            if (p < a) {
-                // Ćwiartka A (lewa góra) – brak przesunięcia
-            }
-            else if (p < a + b) {
-                // Ćwiartka B (prawa góra) – przesunięcie w prawo
-                y += (1 << (K - j - 1));
-            }
-            else if (p < a + b + c) {
-                // Ćwiartka C (lewy dół) – przesunięcie w dół
-                x += (1 << (K - j - 1));
+    for (uint64_t i = 0; i < E; ++i) {
+        uint32_t x, y;
+        draw_edge_fast(gen, th, x, y);
+        // Jeśli takiej krawędzi jeszcze nie ma, dodajemy ją do listy
+        if (seen->insert(edge_key(x, y))) {
+            accept_edge(x, y);
+        }
+        else {
+            i--;  // Jeśli krawędź już istnieje, powtarzamy próbę
+        }
+    }
+}
+
+// Liczba krawędzi losowanych z jednego strumienia liczb losowych
+const uint64_t RMAT_BLOCK = 1 << 16;
+
+// Uruchomienie funkcji fn(nr_watku) na podanej liczbie wątków
+template <typename Fn>
+void run_threads(unsigned threads, Fn fn) {
+    vector<thread> pool;
+    for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back(fn, t);
+    for (auto& th : pool)
+        th.join();
+}
+
+// Funkcja generująca graf metodą R-MAT wielowątkowo
+// Krawędzie są losowane blokami po RMAT_BLOCK; blok nr i ma własny generator z ziarnem
+// (seed, i), więc wynik zależy tylko od ziarna, a nie od liczby wątków.
+// Wynik jest taki sam, jak przy losowaniu sekwencyjnym z ponawianiem: E pierwszych
+// (w kolejności strumienia) różnych krawędzi. Powtórzenia są usuwane globalnie:
+// pary (klucz, pozycja) są dzielone na kubełki według skrótu klucza, a każdy kubełek
+// jest sortowany i oczyszczany z powtórzeń przez osobny wątek.
+void generate_RMAT_parallel(unsigned threads, uint64_t seed) {
+    edges.clear();
+    if (E == 0)
+        return;  // brak krawędzi do wyboru (nth_element poniżej wymaga E >= 1)
+
+    struct Candidate {
+        uint64_t key;
+        uint64_t pos;  // pozycja w strumieniu losowań
+    };
+
+    vector<uint64_t> stream;      // klucze wszystkich wylosowanych krawędzi
+    vector<Candidate> unique_edges;
+    uint64_t wanted = E;          // liczba krawędzi do wylosowania w tej rundzie
+
+    while (true) {
+        // 1. Losowanie kolejnych pełnych bloków strumienia
+        uint64_t first_block = stream.size() / RMAT_BLOCK;
+        uint64_t blocks = (wanted + RMAT_BLOCK - 1) / RMAT_BLOCK;
+        stream.resize((first_block + blocks) * RMAT_BLOCK);
+        atomic<uint64_t> next_block(0);
+        QuadrantThresholds th = make_thresholds();
+        run_threads(threads, [&](unsigned) {
+            for (uint64_t blk = next_block++; blk < blocks; blk = next_block++) {
+                uint64_t id = first_block + blk;
+                seed_seq seq{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32),
+                    static_cast<uint32_t>(id), static_cast<uint32_t>(id >> 32) };
+                mt19937_64 gen(seq);
+                uint64_t* out = stream.data() + id * RMAT_BLOCK;
+                for (uint64_t i = 0; i < RMAT_BLOCK; ++i) {
+                    uint32_t x, y;
+                    draw_edge_fast(gen, th, x, y);
+                    out[i] = edge_key(x, y);
+                }
             }
-            else {
-                // Ćwiartka D (prawy dół) – przesunięcie w dół i w prawo
-                x += (1 << (K - j - 1));
-                y += (1 << (K - j - 1));
+        });
+
+        // 2. Podział par (klucz, pozycja) na kubełki według skrótu klucza
+        uint64_t buckets = static_cast<uint64_t>(threads) * 8;
+        vector<vector<uint64_t>> counts(threads, vector<uint64_t>(buckets + 1, 0));
+        uint64_t per_thread = (stream.size() + threads - 1) / threads;
+        run_threads(threads, [&](unsigned t) {
+            uint64_t begin = min<uint64_t>(stream.size(), t * per_thread);
+            uint64_t end = min<uint64_t>(stream.size(), begin + per_thread);
+            for (uint64_t i = begin; i < end; ++i)
+                counts[t][mix_key(stream[i]) % buckets]++;
+        });
+        vector<uint64_t> bucket_start(buckets + 1, 0);
+        vector<vector<uint64_t>> write_pos(threads, vector<uint64_t>(buckets));
+        uint64_t offset = 0;
+        for (uint64_t bk = 0; bk < buckets; ++bk) {
+            bucket_start[bk] = offset;
+            for (unsigned t = 0; t < threads; ++t) {
+                write_pos[t][bk] = offset;
+                offset += counts[t][bk];
             }
         }
-        // Jeśli w wybranej komórce nie ma krawędzi, ustawiamy 1
-        if (A[x][y] == 0) {
-            A[x][y] = 1;
+        bucket_start[buckets] = offset;
+        vector<Candidate> candidates(stream.size());
+        run_threads(threads, [&](unsigned t) {
+            uint64_t begin = min<uint64_t>(stream.size(), t * per_thread);
+            uint64_t end = min<uint64_t>(stream.size(), begin + per_thread);
+            for (uint64_t i = begin; i < end; ++i)
+                candidates[write_pos[t][mix_key(stream[i]) % buckets]++] = { stream[i], i };
+        });
+
+        // 3. Usuwanie powtórzeń w kubełkach: zostaje pierwsze wystąpienie każdej krawędzi
+        vector<uint64_t> survivors(buckets, 0);
+        atomic<uint64_t> next_bucket(0);
+        run_threads(threads, [&](unsigned) {
+            for (uint64_t bk = next_bucket++; bk < buckets; bk = next_bucket++) {
+                Candidate* first = candidates.data() + bucket_start[bk];
+                Candidate* last = candidates.data() + bucket_start[bk + 1];
+                sort(first, last, [](const Candidate& l, const Candidate& r) {
+                    return l.key != r.key ? l.key < r.key : l.pos < r.pos;
+                });
+                Candidate* kept = unique(first, last, [](const Candidate& l, const Candidate& r) {
+                    return l.key == r.key;
+                });
+                survivors[bk] = kept - first;
+            }
+        });
+
+        unique_edges.clear();
+        for (uint64_t bk = 0; bk < buckets; ++bk)
+            unique_edges.insert(unique_edges.end(), candidates.begin() + bucket_start[bk],
+                candidates.begin() + bucket_start[bk] + survivors[bk]);
+
+        if (unique_edges.size() >= E)
+            break;
+        // Za mało różnych krawędzi - dolosuj (z zapasem) kolejne bloki strumienia
+        uint64_t missing = E - unique_edges.size();
+        wanted = missing + missing / 2 + 1;
+    }
+
+    // 4. Wybór E różnych krawędzi o najwcześniejszych pozycjach w strumieniu
+    auto by_position = [](const Candidate& l, const Candidate& r) { return l.pos < r.pos; };
+    nth_element(unique_edges.begin(), unique_edges.begin() + (E - 1), unique_edges.end(), by_position);
+    unique_edges.resize(E);
+    sort(unique_edges.begin(), unique_edges.end(), by_position);
+
+    edges.clear();
+    edges.reserve(E);
+    for (const Candidate& cand : unique_edges)
+        accept_edge(static_cast<uint32_t>(cand.key >> 32), static_cast<uint32_t>(cand.key));
+}
+
+// Mikrobenchmark jąder losujących: liczba krawędzi na sekundę (bez usuwania powtórzeń)
+void benchmark_kernels(uint64_t count) {
+    mt19937 ref_gen(12345);
+    uniform_real_distribution<double> dis(0.0, 1.0);
+    mt19937_64 fast_gen(12345);
+    QuadrantThresholds th = make_thresholds();
+    uint64_t checksum = 0;
+
+    auto start = chrono::high_resolution_clock::now();
+    for (uint64_t i = 0; i < count; ++i) {
+        uint32_t x, y;
+        draw_edge(ref_gen, dis, x, y);
+        checksum += x ^ y;
+    }
+    auto middle = chrono::high_resolution_clock::now();
+    for (uint64_t i = 0; i < count; ++i) {
+        uint32_t x, y;
+        draw_edge_fast(fast_gen, th, x, y);
+        checksum += x ^ y;
+    }
+    auto end = chrono::high_resolution_clock::now();
+
+    double ref_s = chrono::duration<double>(middle - start).count();
+    double fast_s = chrono::duration<double>(end - middle).count();
+    cout << "Jadro referencyjne (double, mt19937): " << count / ref_s << " krawedzi/s\n";
+    cout << "Jadro szybkie (progi 16-bit, mt19937_64): " << count / fast_s << " krawedzi/s\n";
+    cout << "Przyspieszenie: " << ref_s / fast_s << "x (suma kontrolna " << checksum << ")\n";
+}
+
+// Kierunek krawędzi przy budowie CSR
+enum class CSRDirection {
+    Forward,     // sąsiedzi = wierzchołki docelowe krawędzi wychodzących
+    Transposed,  // sąsiedzi = źródła krawędzi wchodzących
+    Symmetric    // graf nieskierowany: każda krawędź w obu kierunkach
+};
+
+// Funkcja budująca reprezentację CSR z listy krawędzi (sortowanie przez zliczanie, O(N + E))
+CSRGraph build_CSR(const vector<Edge>& edge_list, uint64_t vertices,
+    CSRDirection direction = CSRDirection::Forward) {
+    CSRGraph graph;
+    graph.offsets.assign(vertices + 1, 0);
+    for (const Edge& e : edge_list) {
+        if (direction != CSRDirection::Transposed) graph.offsets[e.from + 1]++;
+        if (direction != CSRDirection::Forward) graph.offsets[e.to + 1]++;
+    }
+    for (uint64_t v = 0; v < vertices; ++v)
+        graph.offsets[v + 1] += graph.offsets[v];
+
+    graph.targets.resize(graph.offsets[vertices]);
+    vector<uint64_t> next(graph.offsets.begin(), graph.offsets.end() - 1);
+    for (const Edge& e : edge_list) {
+        if (direction != CSRDirection::Transposed) graph.targets[next[e.from]++] = e.to;
+        if (direction != CSRDirection::Forward) graph.targets[next[e.to]++] = e.from;
+    }
+    return graph;
+}
+
+// Bufor zapisu: dane trafiają do dużego bloku pamięci, który jest zapisywany
+// do pliku jednym wywołaniem write po zapełnieniu
+class BufferedWriter {
+public:
+    static const size_t BUFFER_SIZE = 1 << 22;
+
+    explicit BufferedWriter(ostream& os) : os(os), buffer(BUFFER_SIZE), pos(0) {}
+    ~BufferedWriter() { flush(); }
+
+    void write_char(char ch) {
+        if (pos == BUFFER_SIZE)
+            flush();
+        buffer[pos++] = ch;
+    }
+
+    void write_string(const string& text) {
+        for (char ch : text)
+            write_char(ch);
+    }
+
+    // Liczba w zapisie dziesiętnym (bez pośrednich napisów)
+    void write_decimal(uint64_t value) {
+        char digits[20];
+        int len = 0;
+        do {
+            digits[len++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        if (pos + len > BUFFER_SIZE)
+            flush();
+        while (len > 0)
+            buffer[pos++] = digits[--len];
+    }
+
+    // Liczba binarnie, little-endian, na 'bytes' bajtach
+    void write_le(uint64_t value, int bytes) {
+        if (pos + bytes > BUFFER_SIZE)
+            flush();
+        for (int i = 0; i < bytes; ++i)
+            buffer[pos++] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+
+    void flush() {
+        os.write(buffer.data(), pos);
+        pos = 0;
+    }
+
+private:
+    ostream& os;
+    vector<char> buffer;
+    size_t pos;
+};
+
+// Formaty zapisu grafu
+enum class OutputFormat {
+    Text,          // output.txt: lista krawędzi "wiersz kolumna" oraz statystyki
+    MatrixMarket,  // output.mtx: Matrix Market, format współrzędnych (indeksy od 1)
+    BinaryEdges,   // output.bin: nagłówek + pary (uint32, uint32)
+    BinaryCSR      // output.csr: nagłówek + offsets (uint64) + targets (uint32)
+};
+
+// Funkcja zapisująca graf w formacie Matrix Market (pattern - bez wartości)
+void save_matrix_market(ostream& os, const CSRGraph& graph) {
+    BufferedWriter out(os);
+    out.write_string("%%MatrixMarket matrix coordinate pattern general\n");
+    out.write_decimal(N);
+    out.write_char(' ');
+    out.write_decimal(N);
+    out.write_char(' ');
+    out.write_decimal(graph.targets.size());
+    out.write_char('\n');
+    for (uint64_t v = 0; v < N; ++v) {
+        for (uint64_t i = graph.offsets[v]; i < graph.offsets[v + 1]; ++i) {
+            out.write_decimal(v + 1);
+            out.write_char(' ');
+            out.write_decimal(static_cast<uint64_t>(graph.targets[i]) + 1);
+            out.write_char('\n');
         }
-        else {
-            i--;  // Jeśli krawędź już istnieje, powtarzamy próbę
+    }
+}
+
+// Nagłówek formatów binarnych (24 B, little-endian):
+// magic (8 B) | N (u64) | E (u64)
+void write_binary_header(BufferedWriter& out, const char* magic, uint64_t edge_count) {
+    for (int i = 0; i < 8; ++i)
+        out.write_char(magic[i]);
+    out.write_le(N, 8);
+    out.write_le(edge_count, 8);
+}
+
+// Funkcja zapisująca binarną listę krawędzi: nagłówek "RMATEDGE", a po nim E par
+// (wiersz, kolumna) jako uint32 - wierzchołki mieszczą się w 32 bitach, bo K <= 32
+void save_binary_edges(ostream& os, const CSRGraph& graph) {
+    BufferedWriter out(os);
+    write_binary_header(out, "RMATEDGE", graph.targets.size());
+    for (uint64_t v = 0; v < N; ++v) {
+        for (uint64_t i = graph.offsets[v]; i < graph.offsets[v + 1]; ++i) {
+            out.write_le(v, 4);
+            out.write_le(graph.targets[i], 4);
         }
     }
 }
 
+// Funkcja zapisująca binarny CSR: nagłówek "RMATCSR\0", N + 1 wartości offsets (uint64)
+// i E wartości targets (uint32)
+void save_binary_CSR(ostream& os, const CSRGraph& graph) {
+    BufferedWriter out(os);
+    write_binary_header(out, "RMATCSR", graph.targets.size());
+    for (uint64_t offset : graph.offsets)
+        out.write_le(offset, 8);
+    for (uint32_t target : graph.targets)
+        out.write_le(target, 4);
+}
+
+// Statystyki rozkładu stopni wyznaczane z liczników (O(N + E), bez macierzy i bez CSR)
+struct DegreeStats {
+    vector<uint64_t> histogram;  // histogram[s] = liczba wierzchołków o stopniu s
+    uint64_t max_degree = 0;
+    uint64_t p50 = 0, p90 = 0, p99 = 0;  // percentyle stopnia
+    double mean = 0.0;
+    double alpha = 0.0;          // wykładnik rozkładu potęgowego (estymator MLE dla s >= 1)
+};
+
+DegreeStats degree_stats(const vector<uint32_t>& degree) {
+    DegreeStats stats;
+    for (uint32_t deg : degree)
+        stats.max_degree = max<uint64_t>(stats.max_degree, deg);
+    stats.histogram.assign(stats.max_degree + 1, 0);
+    for (uint32_t deg : degree)
+        stats.histogram[deg]++;
+
+    // Percentyle (najbliższa pozycja) z histogramu skumulowanego
+    uint64_t vertices = degree.size();
+    uint64_t total = 0;
+    uint64_t cumulative = 0;
+    uint64_t* targets[3] = { &stats.p50, &stats.p90, &stats.p99 };
+    const double levels[3] = { 0.50, 0.90, 0.99 };
+    int next = 0;
+    for (uint64_t s = 0; s <= stats.max_degree; ++s) {
+        cumulative += stats.histogram[s];
+        total += s * stats.histogram[s];
+        while (next < 3 && cumulative >= ceil(levels[next] * vertices))
+            *targets[next++] = s;
+    }
+    stats.mean = vertices > 0 ? static_cast<double>(total) / vertices : 0.0;
+
+    // Dopasowanie rozkładu potęgowego P(s) ~ s^(-alpha) dla s >= 1
+    // (przybliżenie dyskretnego estymatora MLE: alpha = 1 + n / suma ln(s / 0.5))
+    double log_sum = 0.0;
+    uint64_t positive = 0;
+    for (uint64_t s = 1; s <= stats.max_degree; ++s) {
+        log_sum += stats.histogram[s] * log(s / 0.5);
+        positive += stats.histogram[s];
+    }
+    stats.alpha = log_sum > 0.0 ? 1.0 + positive / log_sum : 0.0;
+    return stats;
+}
+
+// Zapis statystyk jednego rodzaju stopni
+void write_degree_stats(ostream& out, const string& name, const DegreeStats& stats) {
+    out << "Stopien " << name << ": max " << stats.max_degree
+        << ", srednia " << stats.mean
+        << ", p50 " << stats.p50 << ", p90 " << stats.p90 << ", p99 " << stats.p99
+        << ", wykladnik potegowy alfa " << stats.alpha << "\n";
+}
+
 // Funkcja zapisująca wyniki do pliku wyjściowego
-void save_to_file(const string& filename, long long duration_us) {
+// Lista krawędzi trafia do output.txt tylko w formacie tekstowym, statystyki - zawsze
+void save_to_file(const string& filename, const CSRGraph& graph, long long duration_us,
+    bool with_edges) {
+    // Statystyki nie zależą od CSR - graf jest potrzebny tylko do zapisu listy krawędzi
     ofstream out(filename);
     if (!out) {
         cerr << "Blad otwarcia pliku wyjsciowego: " << filename << endl;
         exit(1);
     }
 
-    out << "\nLiczba wierzcholkow N: " << N << "\n\n";
+    out << "\nLiczba wierzcholkow N: " << N << "\n";
+    out << "Liczba krawedzi E: " << graph.targets.size() << "\n\n";
 
-    // Zapis macierzy sąsiedztwa
-    for (const auto& row : A) {
-        for (int val : row) {
-            out << val << " ";
+    // Zapis listy krawędzi ("wiersz kolumna"), uporządkowanej według wierszy
+    if (with_edges) {
+        BufferedWriter writer(out);
+        for (uint64_t v = 0; v < N; ++v) {
+            for (uint64_t i = graph.offsets[v]; i < graph.offsets[v + 1]; ++i) {
+                writer.write_decimal(v);
+                writer.write_char(' ');
+                writer.write_decimal(graph.targets[i]);
+                writer.write_char('\n');
+            }
         }
-        out << "\n";
+        writer.write_char('\n');
     }
-    out << "\n";
 
     // Obliczenie gęstości grafu:
     // Przyjmujemy, że maksymalna liczba możliwych krawędzi (bez pętli) wynosi N*(N-1)
-    double density = static_cast<double>(E) / (N * (N - 1));
+    double density = static_cast<double>(E) / (static_cast<double>(N) * (N - 1));
     out << "Gestosc grafu: " << density << "\n";
 
-    // Obliczenie histogramu rozkładu liczby połączeń (liczba jedynek w każdym wierszu)
-    map<int, int> degree_histogram;
-    int no_edges = 0;
-    for (int i = 0; i < N; ++i) {
-        int degree = 0;
-        for (int j = 0; j < N; ++j) {
-            if (A[i][j] == 1) {
-                degree++;
-            }
-        }
-        if (degree == 0) {
-            no_edges++;
-        }
-        degree_histogram[degree]++;
-    }
+    // Statystyki stopni z liczników prowadzonych w trakcie generowania
+    DegreeStats out_stats = degree_stats(out_degree);
+    DegreeStats in_stats = degree_stats(in_degree);
+    out << "\n";
+    write_degree_stats(out, "wyjsciowy", out_stats);
+    write_degree_stats(out, "wejsciowy", in_stats);
 
     out << "\nHistogram rozkladu liczby polaczen:\n";
-    for (const auto& entry : degree_histogram) {
-        out << "Liczba wierzcholkow z " << entry.first
-            << " polaczeniami: " << entry.second << "\n";
+    for (uint64_t s = 0; s <= out_stats.max_degree; ++s) {
+        if (out_stats.histogram[s] > 0)
+            out << "Liczba wierzcholkow z " << s
+                << " polaczeniami: " << out_stats.histogram[s] << "\n";
+    }
+
+    out << "\nHistogram stopni wejsciowych:\n";
+    for (uint64_t s = 0; s <= in_stats.max_degree; ++s) {
+        if (in_stats.histogram[s] > 0)
+            out << "Liczba wierzcholkow z " << s
+                << " krawedziami wchodzacymi: " << in_stats.histogram[s] << "\n";
     }
 
     // Zapis czasu generowania grafu
@@ -131,21 +739,449 @@ void save_to_file(const string& filename, long long duration_us) {
     out.close();
 }
 
-int main() {
+// Stała pula wątków dla jąder grafowych: wątki tworzone są raz (poza pomiarem czasu),
+// a run(fn) wykonuje fn(t) dla t = 0..size()-1 i czeka na wszystkie (t = 0 to wątek wołający).
+// Zastępuje run_threads tam, gdzie fazy równoległe są krótkie i bardzo liczne.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads) : threads(max(1u, threads)) {
+        for (unsigned t = 1; t < this->threads; ++t)
+            workers.emplace_back([this, t]() { work(t); });
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+            ++generation;
+        }
+        start_signal.notify_all();
+        for (auto& th : workers)
+            th.join();
+    }
+
+    unsigned size() const { return threads; }
+
+    void run(const function<void(unsigned)>& fn) {
+        {
+            lock_guard<mutex> guard(lock);
+            job = &fn;
+            pending = threads - 1;
+            ++generation;
+        }
+        start_signal.notify_all();
+        fn(0);
+        unique_lock<mutex> guard(lock);
+        done_signal.wait(guard, [&] { return pending == 0; });
+        job = nullptr;
+    }
+
+private:
+    void work(unsigned t) {
+        uint64_t seen = 0;
+        while (true) {
+            const function<void(unsigned)>* current;
+            {
+                unique_lock<mutex> guard(lock);
+                start_signal.wait(guard, [&] { return generation != seen; });
+                seen = generation;
+                if (stopping)
+                    return;
+                current = job;
+            }
+            (*current)(t);
+            lock_guard<mutex> guard(lock);
+            if (--pending == 0)
+                done_signal.notify_one();
+        }
+    }
+
+    unsigned threads;
+    vector<thread> workers;
+    mutex lock;
+    condition_variable start_signal, done_signal;
+    const function<void(unsigned)>* job = nullptr;
+    unsigned pending = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+};
+
+// Wynik jednego przeszukiwania wszerz
+struct BFSResult {
+    uint64_t visited;   // liczba odwiedzonych wierzchołków
+    uint64_t edges;     // liczba krawędzi w składowej (do TEPS)
+    double seconds;
+};
+
+// Przeszukiwanie wszerz z optymalizacją kierunku (Beamer i in.) na grafie nieskierowanym:
+// krok "z góry" rozszerza kolejkę frontu, a gdy krawędzie frontu przeważają nad krawędziami
+// nieodwiedzonych wierzchołków, krok "z dołu" pozwala nieodwiedzonym szukać rodzica we froncie.
+// Rodzice są zapisywani w parent (-1 = nieodwiedzony).
+BFSResult bfs_direction_optimizing(const CSRGraph& graph, uint32_t root, ThreadPool& pool,
+    vector<atomic<int64_t>>& parent) {
+    const uint64_t ALPHA = 14, BETA = 24;  // progi przełączania kierunku
+    const unsigned threads = pool.size();
+    auto start = chrono::high_resolution_clock::now();
+    auto degree = [&](uint64_t v) { return graph.offsets[v + 1] - graph.offsets[v]; };
+    auto slice = [&](unsigned t, uint64_t count, uint64_t& begin, uint64_t& end) {
+        uint64_t per_thread = (count + threads - 1) / threads;
+        begin = min<uint64_t>(count, t * per_thread);
+        end = min<uint64_t>(count, begin + per_thread);
+    };
+
+    pool.run([&](unsigned t) {
+        uint64_t begin, end;
+        slice(t, N, begin, end);
+        for (uint64_t v = begin; v < end; ++v)
+            parent[v].store(-1, memory_order_relaxed);
+    });
+    parent[root] = root;
+
+    vector<uint32_t> frontier(1, root);        // front jako kolejka (krok z góry)
+    vector<uint8_t> in_frontier, in_next;      // front jako mapa (krok z dołu)
+    bool bottom_up = false;
+    uint64_t frontier_size = 1;
+    uint64_t unexplored_edges = graph.targets.size() - degree(root);
+    uint64_t visited = 1;
+    uint64_t component_edges = degree(root);
+
+    while (frontier_size > 0) {
+        vector<uint64_t> found(threads, 0), found_edges(threads, 0);
+        if (!bottom_up) {
+            uint64_t frontier_edges = 0;
+            for (uint32_t u : frontier)
+                frontier_edges += degree(u);
+            if (frontier_edges > unexplored_edges / ALPHA) {
+                // Przejście na krok z dołu: front jako mapa bajtów
+                bottom_up = true;
+                in_frontier.assign(N, 0);
+                for (uint32_t u : frontier)
+                    in_frontier[u] = 1;
+            }
+        }
+        else if (frontier_size < N / BETA) {
+            // Powrót do kroku z góry: front z mapy do kolejki
+            bottom_up = false;
+            frontier.clear();
+            for (uint64_t v = 0; v < N; ++v)
+                if (in_frontier[v])
+                    frontier.push_back(static_cast<uint32_t>(v));
+        }
+
+        if (!bottom_up) {
+            vector<vector<uint32_t>> local(threads);
+            pool.run([&](unsigned t) {
+                uint64_t begin, end;
+                slice(t, frontier.size(), begin, end);
+                for (uint64_t i = begin; i < end; ++i) {
+                    uint32_t u = frontier[i];
+                    for (uint64_t e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+                        uint32_t v = graph.targets[e];
+                        int64_t expected = -1;
+                        if (parent[v].load(memory_order_relaxed) == -1
+                            && parent[v].compare_exchange_strong(expected, u)) {
+                            local[t].push_back(v);
+                            found_edges[t] += degree(v);
+                        }
+                    }
+                }
+            });
+            frontier.clear();
+            for (auto& part : local)
+                frontier.insert(frontier.end(), part.begin(), part.end());
+            frontier_size = frontier.size();
+        }
+        else {
+            in_next.assign(N, 0);
+            pool.run([&](unsigned t) {
+                uint64_t begin, end;
+                slice(t, N, begin, end);
+                for (uint64_t v = begin; v < end; ++v) {
+                    if (parent[v].load(memory_order_relaxed) != -1)
+                        continue;
+                    for (uint64_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+                        uint32_t u = graph.targets[e];
+                        if (in_frontier[u]) {
+                            parent[v].store(u, memory_order_relaxed);
+                            in_next[v] = 1;
+                            found[t]++;
+                            found_edges[t] += degree(v);
+                            break;
+                        }
+                    }
+                }
+            });
+            in_frontier.swap(in_next);
+            frontier_size = 0;
+            for (uint64_t f : found)
+                frontier_size += f;
+        }
+
+        for (uint64_t f : found_edges) {
+            unexplored_edges -= f;
+            component_edges += f;
+        }
+        visited += frontier_size;
+    }
+
+    BFSResult result;
+    result.visited = visited;
+    result.edges = component_edges / 2;  // każda krawędź nieskierowana występuje dwa razy
+    result.seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    return result;
+}
+
+// PageRank ze stałą liczbą iteracji (wersja "pull" na krawędziach wchodzących);
+// ranga wierzchołków bez krawędzi wychodzących jest rozdzielana równo między wszystkie
+vector<double> pagerank(const CSRGraph& forward, const CSRGraph& transposed, int iterations,
+    ThreadPool& pool) {
+    const double DAMPING = 0.85;
+    const unsigned threads = pool.size();
+    vector<double> rank(N, 1.0 / N), contribution(N), next(N);
+    auto slice = [&](unsigned t, uint64_t& begin, uint64_t& end) {
+        uint64_t per_thread = (N + threads - 1) / threads;
+        begin = min<uint64_t>(N, t * per_thread);
+        end = min<uint64_t>(N, begin + per_thread);
+    };
+
+    for (int it = 0; it < iterations; ++it) {
+        vector<double> dangling(threads, 0.0);
+        pool.run([&](unsigned t) {
+            uint64_t begin, end;
+            slice(t, begin, end);
+            for (uint64_t u = begin; u < end; ++u) {
+                uint64_t out = forward.offsets[u + 1] - forward.offsets[u];
+                contribution[u] = out > 0 ? rank[u] / out : 0.0;
+                if (out == 0)
+                    dangling[t] += rank[u];
+            }
+        });
+        double dangling_sum = 0.0;
+        for (double part : dangling)
+            dangling_sum += part;
+        double base = (1.0 - DAMPING) / N + DAMPING * dangling_sum / N;
+
+        pool.run([&](unsigned t) {
+            uint64_t begin, end;
+            slice(t, begin, end);
+            for (uint64_t v = begin; v < end; ++v) {
+                double sum = 0.0;
+                for (uint64_t e = transposed.offsets[v]; e < transposed.offsets[v + 1]; ++e)
+                    sum += contribution[transposed.targets[e]];
+                next[v] = base + DAMPING * sum;
+            }
+        });
+        rank.swap(next);
+    }
+    return rank;
+}
+
+// Benchmark jąder grafowych w stylu Graph500: BFS z losowych korzeni (TEPS) i PageRank
+void run_graph_kernels(ostream& report, int roots, int pr_iterations, unsigned threads, uint64_t seed) {
+    auto build_start = chrono::high_resolution_clock::now();
+    CSRGraph symmetric = build_CSR(edges, N, CSRDirection::Symmetric);
+    CSRGraph forward = build_CSR(edges, N, CSRDirection::Forward);
+    CSRGraph transposed = build_CSR(edges, N, CSRDirection::Transposed);
+    double build_s = chrono::duration<double>(chrono::high_resolution_clock::now() - build_start).count();
+    report << "\nBudowa CSR (symetryczny, prosty, transponowany): " << build_s * 1e3 << " ms\n";
+
+    // Wątki tworzone raz, przed pomiarami BFS i PageRank
+    ThreadPool pool(threads);
+
+    // Korzenie losowane spośród wierzchołków o niezerowym stopniu
+    mt19937_64 gen(seed);
+    uniform_int_distribution<uint64_t> pick(0, N - 1);
+    vector<atomic<int64_t>> parent(N);
+    double inverse_teps_sum = 0.0, total_s = 0.0;
+    int done = 0;
+    for (int attempt = 0; done < roots && attempt < roots * 100; ++attempt) {
+        uint32_t root = static_cast<uint32_t>(pick(gen));
+        if (symmetric.offsets[root + 1] == symmetric.offsets[root])
+            continue;
+        BFSResult r = bfs_direction_optimizing(symmetric, root, pool, parent);
+        double teps = r.edges / r.seconds;
+        inverse_teps_sum += 1.0 / teps;
+        total_s += r.seconds;
+        done++;
+        report << "BFS z " << root << ": odwiedzono " << r.visited << " wierzcholkow, "
+            << r.edges << " krawedzi, " << r.seconds * 1e3 << " ms, " << teps << " TEPS\n";
+    }
+    if (done > 0)
+        report << "BFS: " << done << " korzeni, sredni czas " << total_s / done * 1e3
+            << " ms, srednia harmoniczna " << done / inverse_teps_sum << " TEPS\n";
+
+    auto pr_start = chrono::high_resolution_clock::now();
+    vector<double> rank = pagerank(forward, transposed, pr_iterations, pool);
+    double pr_s = chrono::duration<double>(chrono::high_resolution_clock::now() - pr_start).count();
+    uint64_t best = max_element(rank.begin(), rank.end()) - rank.begin();
+    report << "PageRank: " << pr_iterations << " iteracji, " << pr_s * 1e3 << " ms ("
+        << pr_s * 1e3 / max(1, pr_iterations) << " ms/iteracje, "
+        << static_cast<double>(edges.size()) * pr_iterations / pr_s << " krawedzi/s), "
+        << "najwyzsza ranga: wierzcholek " << best << " (" << rank[best] << ")\n";
+}
+
+int main(int argc, char* argv[]) {
+    // Generowanie wielowątkowe z powtarzalnymi strumieniami: Lab3 --threads T [--seed S]
+    // Porównanie jąder losujących: Lab3 --bench-kernel [liczba_krawedzi]
+    // Format zapisu grafu: Lab3 --format txt|mm|bin|csr
+    // Usuwanie powtórzeń (jeden wątek): Lab3 --dedup auto|bitset|hash|sort
+    // Jądra grafowe po generowaniu: Lab3 --kernels [liczba_korzeni] [--pr-iters I]
+    unsigned threads = 1;
+    int kernel_roots = 0;
+    int pr_iterations = 20;
+    DedupMode dedup = DedupMode::Auto;
+    OutputFormat format = OutputFormat::Text;
+    uint64_t bench_edges = 0;
+    bool seeded = false;
+    uint64_t seed = 0;
+    // Niepoprawne wartości liczbowe (stoi/stoull) zgłaszają wyjątki
+    try {
+        for (int i = 1; i < argc; ++i) {
+            string arg = argv[i];
+            if (arg == "--threads" && i + 1 < argc) {
+                threads = max(1, stoi(argv[++i]));
+            }
+            else if (arg == "--seed" && i + 1 < argc) {
+                seed = stoull(argv[++i]);
+                seeded = true;
+            }
+            else if (arg == "--format" && i + 1 < argc) {
+                string name = argv[++i];
+                if (name == "txt") format = OutputFormat::Text;
+                else if (name == "mm") format = OutputFormat::MatrixMarket;
+                else if (name == "bin") format = OutputFormat::BinaryEdges;
+                else if (name == "csr") format = OutputFormat::BinaryCSR;
+                else {
+                    cerr << "Nieznany format: " << name << endl;
+                    return 1;
+                }
+            }
+            else if (arg == "--dedup" && i + 1 < argc) {
+                string name = argv[++i];
+                if (name == "auto") dedup = DedupMode::Auto;
+                else if (name == "bitset") dedup = DedupMode::Bitset;
+                else if (name == "hash") dedup = DedupMode::Hash;
+                else if (name == "sort") dedup = DedupMode::Sort;
+                else {
+                    cerr << "Nieznany sposob usuwania powtorzen: " << name << endl;
+                    return 1;
+                }
+            }
+            else if (arg == "--kernels") {
+                kernel_roots = 16;
+                if (i + 1 < argc && argv[i + 1][0] != '-')
+                    kernel_roots = max(1, stoi(argv[++i]));
+            }
+            else if (arg == "--pr-iters" && i + 1 < argc) {
+                pr_iterations = max(1, stoi(argv[++i]));
+            }
+            else if (arg == "--bench-kernel") {
+                bench_edges = 10000000;
+                if (i + 1 < argc && argv[i + 1][0] != '-')
+                    bench_edges = stoull(argv[++i]);
+            }
+            else {
+                cerr << "Nieznana opcja: " << arg << endl;
+                return 1;
+            }
+        }
+    }
+    catch (const logic_error&) {
+        cerr << "Blad: niepoprawna wartosc liczbowa w argumentach wywolania" << endl;
+        return 1;
+    }
+    if (!seeded)
+        seed = (static_cast<uint64_t>(random_device{}()) << 32) | random_device{}();
+
     // Wczytanie danych wejściowych z pliku input.txt
     read_input("input.txt");
 
+    if (bench_edges > 0) {
+        benchmark_kernels(bench_edges);
+        return 0;
+    }
+
+    if (dedup == DedupMode::Bitset && K >= 32) {
+        cerr << "Blad: mapa bitowa N x N nie miesci sie w pamieci dla K = 32" << endl;
+        return 1;
+    }
+
+    // Zabezpieczenie przed nieskończonym ponawianiem losowania
+    uint64_t reachable = max_reachable_edges();
+    if (E > reachable) {
+        cerr << "Blad: nie da sie wygenerowac " << E << " roznych krawedzi - osiagalnych jest tylko "
+            << reachable << " (N^2 lub mniej przy zerowych prawdopodobienstwach cwiartek)" << endl;
+        return 1;
+    }
+
+    // Lista E krawędzi musi zmieścić się w wektorze (inaczej reserve zgłasza length_error)
+    if (E > edges.max_size()) {
+        cerr << "Blad: E = " << E << " przekracza maksymalny rozmiar listy krawedzi ("
+            << edges.max_size() << ")" << endl;
+        return 1;
+    }
+
     // Pomiar czasu generowania grafu
     auto start = chrono::high_resolution_clock::now();
-    generate_RMAT();
+    try {
+        edges.reserve(E);  // dopiero po sprawdzeniu, że E jest osiągalne
+        if (threads > 1 || seeded)
+            generate_RMAT_parallel(threads, seed);
+        else
+            generate_RMAT(dedup);
+    }
+    catch (const bad_alloc&) {
+        cerr << "Blad: brak pamieci (dla duzego K wybierz --dedup hash lub sort)" << endl;
+        return 1;
+    }
+    catch (const length_error&) {
+        cerr << "Blad: zbyt duze E - struktury pomocnicze przekraczaja maksymalny rozmiar" << endl;
+        return 1;
+    }
     auto end = chrono::high_resolution_clock::now();
     long long duration_us = chrono::duration_cast<chrono::microseconds>(end - start).count();
 
-    // Zapis wyników do pliku output.txt
-    save_to_file("output.txt", duration_us);
+    // Konwersja listy krawędzi do formatu CSR (kolejne O(N + E) pamięci)
+    CSRGraph graph;
+    try {
+        graph = build_CSR(edges, N);
+    }
+    catch (const bad_alloc&) {
+        cerr << "Blad: brak pamieci na reprezentacje CSR grafu" << endl;
+        return 1;
+    }
 
-    cout << "Graf R-MAT zostal wygenerowany i zapisany do pliku output.txt." << endl;
+    // Zapis grafu w wybranym formacie oraz statystyk do pliku output.txt
+    string graph_file = "output.txt";
+    if (format != OutputFormat::Text) {
+        graph_file = format == OutputFormat::MatrixMarket ? "output.mtx"
+            : format == OutputFormat::BinaryEdges ? "output.bin" : "output.csr";
+        ofstream graph_out(graph_file, ios::binary);
+        if (!graph_out) {
+            cerr << "Blad otwarcia pliku wyjsciowego: " << graph_file << endl;
+            return 1;
+        }
+        if (format == OutputFormat::MatrixMarket) save_matrix_market(graph_out, graph);
+        else if (format == OutputFormat::BinaryEdges) save_binary_edges(graph_out, graph);
+        else save_binary_CSR(graph_out, graph);
+    }
+    save_to_file("output.txt", graph, duration_us, format == OutputFormat::Text);
+
+    cout << "Graf R-MAT zostal wygenerowany i zapisany do pliku " << graph_file << "." << endl;
     cout << "Czas generowania: " << duration_us << " us." << endl;
 
+    // Jądra grafowe na wygenerowanym grafie (wyniki dopisywane do output.txt)
+    if (kernel_roots > 0) {
+        ofstream report("output.txt", ios::app);
+        try {
+            run_graph_kernels(report, kernel_roots, pr_iterations, threads, seed);
+        }
+        catch (const bad_alloc&) {
+            cerr << "Blad: brak pamieci na struktury BFS i PageRank" << endl;
+            return 1;
+        }
+        cout << "Wyniki BFS i PageRank dopisano do pliku output.txt." << endl;
+    }
+
     return 0;
 }
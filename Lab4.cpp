@@ -9,6 +9,12 @@
 #include <stdexcept>
 #include <algorithm>
 #include <limits>
+#include <thread>
+#include <bitset>
+#include <atomic>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 using namespace std;
 
@@ -21,23 +27,869 @@ int xor_mod2(const vector<int>& state, const vector<int>& feedback_positions) {
     return result;
 }
 
-// Obliczenie entropii binarnej sekwencji
-double calculate_entropy(const vector<int>& sequence) {
-    int count0 = 0, count1 = 0;
-    for (int bit : sequence) {
-        if (bit == 0) ++count0;
-        else ++count1;
+// Parzystość liczby jedynek w słowie (0 lub 1)
+inline int parity64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_parityll(x);
+#else
+    x ^= x >> 32;
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return static_cast<int>(x & 1);
+#endif
+}
+
+// Rejestr upakowany w słowie: bit j słowa odpowiada state[j], taps to maska pozycji sprzężenia
+struct PackedLFSR {
+    int n;
+    uint64_t state;
+    uint64_t taps;
+    uint64_t mask;  // n najmłodszych bitów
+
+    PackedLFSR(const vector<int>& initial_state, const vector<int>& feedback_positions)
+        : n(static_cast<int>(initial_state.size())), state(0), taps(0) {
+        mask = n == 64 ? ~0ULL : (1ULL << n) - 1;
+        for (int j = 0; j < n; ++j)
+            if (initial_state[j])
+                state |= 1ULL << j;
+        for (int pos : feedback_positions)
+            taps |= 1ULL << pos;
+    }
+
+    // Jeden krok: zwraca bit wyjściowy (state[n-1]) i wsuwa sprzężenie na pozycję 0
+    inline int step() {
+        int output_bit = static_cast<int>(state >> (n - 1)) & 1;
+        int feedback = parity64(state & taps);
+        state = ((state << 1) | static_cast<uint64_t>(feedback)) & mask;
+        return output_bit;
+    }
+};
+
+// Skok o 64 kroki naraz. Rejestr jest liniowy nad GF(2), więc stan po 64 krokach i słowo
+// 64 bitów wyjściowych są sumami XOR wkładów pojedynczych bitów stanu. Wkłady zebrano
+// w tablicach indeksowanych bajtami stanu (8 tablic po 256 wpisów), więc jeden skok
+// to co najwyżej 8 odczytów na każdą z dwóch wartości.
+// Bit i słowa wyjściowego to bit wyjściowy z kroku i (najmłodszy bit = pierwszy krok).
+struct LeapLFSR {
+    static constexpr int STEP = 64;
+    int bytes;  // liczba bajtów stanu, ceil(n / 8)
+    uint64_t next_table[8][256];
+    uint64_t output_table[8][256];
+
+    explicit LeapLFSR(const PackedLFSR& base) : bytes((base.n + 7) / 8) {
+        uint64_t unit_next[64] = {}, unit_output[64] = {};
+        for (int j = 0; j < base.n; ++j) {
+            PackedLFSR lfsr = base;
+            lfsr.state = 1ULL << j;
+            uint64_t word = 0;
+            for (int i = 0; i < STEP; ++i)
+                word |= static_cast<uint64_t>(lfsr.step()) << i;
+            unit_next[j] = lfsr.state;
+            unit_output[j] = word;
+        }
+        for (int b = 0; b < 8; ++b) {
+            next_table[b][0] = output_table[b][0] = 0;
+            for (int v = 1; v < 256; ++v) {
+                int low = 0;
+                while (!((v >> low) & 1)) ++low;
+                next_table[b][v] = next_table[b][v & (v - 1)] ^ unit_next[8 * b + low];
+                output_table[b][v] = output_table[b][v & (v - 1)] ^ unit_output[8 * b + low];
+            }
+        }
+    }
+
+    // Przesuwa stan o 64 kroki i zwraca 64 kolejne bity wyjściowe
+    inline uint64_t leap(uint64_t& state) const {
+        uint64_t next = 0, word = 0;
+        for (int b = 0; b < bytes; ++b) {
+            unsigned v = static_cast<unsigned>(state >> (8 * b)) & 0xFF;
+            next ^= next_table[b][v];
+            word ^= output_table[b][v];
+        }
+        state = next;
+        return word;
+    }
+};
+
+// Skok o dowolną liczbę kroków. Ciąg bitów wchodzących do rejestru spełnia
+// u[m] = XOR_{p in taps} u[m-1-p], więc macierz przejścia M zeruje wielomian
+// P(x) = x^n + SUMA_{p in taps} x^(n-1-p). Jeśli x^t mod P(x) = SUMA c_i x^i, to
+// stan po t krokach jest sumą XOR tych stanów s_i (i < n), dla których c_i = 1.
+struct JumpLFSR {
+    int n;
+    uint64_t mask;
+    uint64_t poly_low;    // P(x) bez składnika x^n, bit i = współczynnik przy x^i
+    uint64_t basis[64];   // stany s_0 .. s_{n-1}
+
+    explicit JumpLFSR(const PackedLFSR& base) : n(base.n), mask(base.mask), poly_low(0) {
+        for (int p = 0; p < n; ++p)
+            if ((base.taps >> p) & 1)
+                poly_low |= 1ULL << (n - 1 - p);
+        PackedLFSR lfsr = base;
+        for (int i = 0; i < n; ++i) {
+            basis[i] = lfsr.state;
+            lfsr.step();
+        }
+    }
+
+    // a * x mod P(x)
+    inline uint64_t mul_x(uint64_t a) const {
+        uint64_t top = (a >> (n - 1)) & 1;
+        a = (a << 1) & mask;
+        return top ? a ^ poly_low : a;
+    }
+
+    // a * b mod P(x), mnożenie schematem Hornera po bitach b
+    uint64_t mul_mod(uint64_t a, uint64_t b) const {
+        uint64_t result = 0;
+        for (int i = n - 1; i >= 0; --i) {
+            result = mul_x(result);
+            if ((b >> i) & 1)
+                result ^= a;
+        }
+        return result;
     }
-    double p0 = count0 / static_cast<double>(sequence.size());
-    double p1 = count1 / static_cast<double>(sequence.size());
+
+    // x^t mod P(x) przez podnoszenie do kwadratu
+    uint64_t x_power(uint64_t t) const {
+        uint64_t result = 1, base = mul_x(1);
+        for (; t > 0; t >>= 1) {
+            if (t & 1)
+                result = mul_mod(result, base);
+            base = mul_mod(base, base);
+        }
+        return result;
+    }
+
+    // Stan rejestru po t krokach od stanu początkowego
+    uint64_t state_after(uint64_t t) const {
+        uint64_t coefficients = x_power(t), state = 0;
+        for (int i = 0; i < n; ++i)
+            if ((coefficients >> i) & 1)
+                state ^= basis[i];
+        return state;
+    }
+};
+
+// Liczba jedynek w słowie
+inline int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Obliczenie entropii binarnej sekwencji z liczności zer i jedynek
+double calculate_entropy(uint64_t count0, uint64_t count1) {
+    uint64_t total = count0 + count1;
+    if (total == 0) return 0.0;
+    double p0 = count0 / static_cast<double>(total);
+    double p1 = count1 / static_cast<double>(total);
     double entropy = 0.0;
     if (p0 > 0.0) entropy -= p0 * log2(p0);
     if (p1 > 0.0) entropy -= p1 * log2(p1);
     return entropy;
 }
 
-int main() {
+// Statystyki ciągu liczone w locie, słowo po słowie (pamięć O(1) względem długości)
+struct SequenceStats {
+    uint64_t length = 0;
+    uint64_t ones = 0;
+    uint64_t runs = 0;       // liczba serii jednakowych bitów
+    int last_bit = 0;
+    uint64_t checksum = 0;   // skrót zawartości, do porównywania ścieżek przy --validate
+
+    // Dodaje bits najmłodszych bitów słowa (najmłodszy bit = najwcześniejszy)
+    void add(uint64_t word, int bits) {
+        if (bits <= 0) return;
+        if (bits < 64) word &= (1ULL << bits) - 1;
+        ones += popcount64(word);
+        if (length == 0 || static_cast<int>(word & 1) != last_bit) ++runs;
+        if (bits > 1) {
+            uint64_t inner = bits == 64 ? ~0ULL >> 1 : (1ULL << (bits - 1)) - 1;
+            runs += popcount64((word ^ (word >> 1)) & inner);
+        }
+        last_bit = static_cast<int>(word >> (bits - 1)) & 1;
+        length += bits;
+        checksum = ((checksum << 5 | checksum >> 59) ^ word) * 0x9E3779B97F4A7C15ULL;
+    }
+
+    bool operator==(const SequenceStats& other) const {
+        return length == other.length && ones == other.ones && runs == other.runs
+            && checksum == other.checksum;
+    }
+};
+
+// Zapis ciągu do pliku binarnego: słowa 64-bitowe little-endian, bit i słowa = i-ty bit
+// ciągu w tym słowie; ostatnie słowo uzupełnione zerami. Zapis dużymi blokami (4 MiB).
+class PackedBitWriter {
+public:
+    explicit PackedBitWriter(const string& filename) : out(filename, ios::binary) {
+        if (!out.is_open())
+            throw runtime_error("Nie mozna otworzyc pliku " + filename);
+        buffer.reserve(BUFFER_SIZE);
+    }
+    ~PackedBitWriter() { flush(); }
+
+    void write_word(uint64_t word) {
+        for (int b = 0; b < 8; ++b)
+            buffer.push_back(static_cast<char>(word >> (8 * b)));
+        if (buffer.size() >= BUFFER_SIZE)
+            flush();
+    }
+
+    void flush() {
+        out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+private:
+    static constexpr size_t BUFFER_SIZE = 1 << 22;
+    ofstream out;
+    vector<char> buffer;
+};
+
+// Odbiorca słów wygenerowanego ciągu: statystyki i opcjonalny zapis do pliku
+struct SequenceSink {
+    SequenceStats stats;
+    PackedBitWriter* writer = nullptr;
+
+    void operator()(uint64_t word, int bits) {
+        stats.add(word, bits);
+        if (writer) writer->write_word(word);
+    }
+};
+
+// Wolna ścieżka referencyjna: rejestr jako vector<int>, przesuwanie element po elemencie
+template <typename Sink>
+void generate_reference(vector<int> state, const vector<int>& feedback_positions, uint64_t length,
+    Sink& sink) {
+    int n = static_cast<int>(state.size());
+    uint64_t word = 0;
+    int bits = 0;
+    for (uint64_t i = 0; i < length; ++i) {
+        int output_bit = state.back();
+        word |= static_cast<uint64_t>(output_bit) << bits;
+        if (++bits == 64) {
+            sink(word, bits);
+            word = 0;
+            bits = 0;
+        }
+
+        int feedback = xor_mod2(state, feedback_positions);
+        for (int j = n - 1; j > 0; --j) {
+            state[j] = state[j - 1];
+        }
+        state[0] = feedback;
+    }
+    if (bits > 0) sink(word, bits);
+}
+
+// Szybka ścieżka: rejestr upakowany w uint64_t, krok = przesunięcie + parzystość (state & taps)
+template <typename Sink>
+void generate_packed(const vector<int>& initial_state, const vector<int>& feedback_positions,
+    uint64_t length, Sink& sink) {
+    PackedLFSR lfsr(initial_state, feedback_positions);
+    uint64_t word = 0;
+    int bits = 0;
+    for (uint64_t i = 0; i < length; ++i) {
+        word |= static_cast<uint64_t>(lfsr.step()) << bits;
+        if (++bits == 64) {
+            sink(word, bits);
+            word = 0;
+            bits = 0;
+        }
+    }
+    if (bits > 0) sink(word, bits);
+}
+
+// Generuje bity [begin, end) od stanu lfsr słowami po 64 bity (ostatnie może być niepełne)
+template <typename Emit>
+void generate_words(PackedLFSR& lfsr, const LeapLFSR& leap_table, uint64_t count, Emit emit) {
+    uint64_t words = count / LeapLFSR::STEP;
+    for (uint64_t w = 0; w < words; ++w)
+        emit(leap_table.leap(lfsr.state), LeapLFSR::STEP);
+    int rest = static_cast<int>(count % LeapLFSR::STEP);
+    if (rest > 0) {
+        uint64_t word = 0;
+        for (int i = 0; i < rest; ++i)
+            word |= static_cast<uint64_t>(lfsr.step()) << i;
+        emit(word, rest);
+    }
+}
+
+// Ścieżka skokowa: 64 bity wyjściowe na iterację, końcówka krokami pojedynczymi
+template <typename Sink>
+void generate_leap(const vector<int>& initial_state, const vector<int>& feedback_positions,
+    uint64_t length, Sink& sink) {
+    PackedLFSR lfsr(initial_state, feedback_positions);
+    LeapLFSR leap_table(lfsr);  // 32 KiB tablic
+    generate_words(lfsr, leap_table, length, [&](uint64_t word, int bits) { sink(word, bits); });
+}
+
+// Generowanie równoległe w rundach: w każdej rundzie wątek t dostaje kolejny fragment
+// (CHUNK_WORDS słów, wyrównany do 64 bitów), przeskakuje do jego początku i generuje go
+// skokami po 64 bity do własnego bufora; po rundzie bufory trafiają do sink po kolei.
+// Pamięć: threads * CHUNK_WORDS słów niezależnie od długości ciągu.
+template <typename Sink>
+void generate_parallel(const vector<int>& initial_state, const vector<int>& feedback_positions,
+    uint64_t length, unsigned threads, Sink& sink) {
+    const uint64_t CHUNK_WORDS = 1 << 16;
+    const uint64_t CHUNK_BITS = CHUNK_WORDS * LeapLFSR::STEP;
+    PackedLFSR base(initial_state, feedback_positions);
+    LeapLFSR leap_table(base);
+    JumpLFSR jump(base);
+
+    vector<vector<uint64_t>> buffers(threads);
+    vector<int> last_bits(threads, 0);
+    for (uint64_t round_begin = 0; round_begin < length; round_begin += CHUNK_BITS * threads) {
+        vector<thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            uint64_t begin = round_begin + t * CHUNK_BITS;
+            buffers[t].clear();
+            if (begin >= length || begin < round_begin)
+                break;
+            uint64_t count = min(CHUNK_BITS, length - begin);
+            workers.emplace_back([&, t, begin, count]() {
+                PackedLFSR lfsr = base;
+                lfsr.state = jump.state_after(begin);
+                generate_words(lfsr, leap_table, count, [&](uint64_t word, int bits) {
+                    buffers[t].push_back(word);
+                    last_bits[t] = bits;
+                });
+            });
+        }
+        for (thread& worker : workers)
+            worker.join();
+        for (unsigned t = 0; t < workers.size(); ++t)
+            for (size_t w = 0; w < buffers[t].size(); ++w)
+                sink(buffers[t][w], w + 1 == buffers[t].size() ? last_bits[t] : LeapLFSR::STEP);
+    }
+}
+
+// ---------------------------------------------------------------------------------------
+// Analiza wielomianu sprzężenia: test pierwotności i dokładny okres
+// ---------------------------------------------------------------------------------------
+
+// Największy wspólny dzielnik (algorytm Euklidesa)
+uint64_t gcd64(uint64_t a, uint64_t b) {
+    while (b != 0) {
+        uint64_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+// a * b mod m bez przepełnienia
+uint64_t mul_mod64(uint64_t a, uint64_t b, uint64_t m) {
+#if defined(__SIZEOF_INT128__)
+    return static_cast<uint64_t>(static_cast<unsigned __int128>(a) * b % m);
+#elif defined(_MSC_VER) && defined(_M_X64) && _MSC_VER >= 1920
+    uint64_t high, remainder;
+    uint64_t low = _umul128(a, b, &high);
+    _udiv128(high % m, low, m, &remainder);
+    return remainder;
+#else
+    uint64_t result = 0;
+    a %= m;
+    for (; b > 0; b >>= 1) {
+        if (b & 1)
+            result = result >= m - a ? result - (m - a) : result + a;
+        a = a >= m - a ? a - (m - a) : a + a;
+    }
+    return result;
+#endif
+}
+
+uint64_t pow_mod64(uint64_t base, uint64_t exponent, uint64_t m) {
+    uint64_t result = 1 % m;
+    for (base %= m; exponent > 0; exponent >>= 1) {
+        if (exponent & 1)
+            result = mul_mod64(result, base, m);
+        base = mul_mod64(base, base, m);
+    }
+    return result;
+}
+
+// Deterministyczny test Millera-Rabina dla liczb 64-bitowych
+bool is_prime64(uint64_t n) {
+    if (n < 2) return false;
+    const uint64_t bases[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+    for (uint64_t p : bases) {
+        if (n % p == 0) return n == p;
+    }
+    uint64_t d = n - 1;
+    int r = 0;
+    while ((d & 1) == 0) {
+        d >>= 1;
+        ++r;
+    }
+    for (uint64_t a : bases) {
+        uint64_t x = pow_mod64(a, d, n);
+        if (x == 1 || x == n - 1) continue;
+        bool composite = true;
+        for (int i = 1; i < r && composite; ++i) {
+            x = mul_mod64(x, x, n);
+            if (x == n - 1) composite = false;
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+// Dzielnik nietrywialny liczby złożonej (rho Pollarda, wariant Brenta)
+uint64_t pollard_rho(uint64_t n) {
+    if (n % 2 == 0) return 2;
+    for (uint64_t c = 1;; ++c) {
+        auto f = [&](uint64_t x) {
+            uint64_t y = mul_mod64(x, x, n) + c;
+            return y >= n || y < c ? y - n : y;
+        };
+        uint64_t x = 2, y = 2, product = 1, divisor = 1, saved = 2;
+        for (uint64_t length = 1; divisor == 1; length <<= 1) {
+            x = y;
+            for (uint64_t i = 0; i < length && divisor == 1; i += 64) {
+                saved = y;
+                for (uint64_t j = 0; j < 64 && i + j < length; ++j) {
+                    y = f(y);
+                    product = mul_mod64(product, x > y ? x - y : y - x, n);
+                }
+                divisor = gcd64(product, n);
+            }
+        }
+        if (divisor == n) {
+            // Iloczyn zebrał wszystkie czynniki: powtórzenie ostatniej partii krok po kroku
+            y = saved;
+            do {
+                y = f(y);
+                divisor = gcd64(x > y ? x - y : y - x, n);
+            } while (divisor == 1);
+        }
+        if (divisor != n) return divisor;
+    }
+}
+
+// Rozkład na czynniki pierwsze (bez powtórzeń, rosnąco)
+vector<uint64_t> prime_factors(uint64_t n) {
+    vector<uint64_t> factors, pending;
+    for (uint64_t p = 2; p < 1000 && p * p <= n; ++p) {
+        if (n % p == 0) {
+            factors.push_back(p);
+            while (n % p == 0) n /= p;
+        }
+    }
+    if (n > 1) pending.push_back(n);
+    while (!pending.empty()) {
+        uint64_t m = pending.back();
+        pending.pop_back();
+        if (m == 1) continue;
+        if (is_prime64(m)) {
+            factors.push_back(m);
+            continue;
+        }
+        uint64_t d = pollard_rho(m);
+        pending.push_back(d);
+        pending.push_back(m / d);
+    }
+    sort(factors.begin(), factors.end());
+    factors.erase(unique(factors.begin(), factors.end()), factors.end());
+    return factors;
+}
+
+// Wielomian nad GF(2), bit i = współczynnik przy x^i (stopień do 127)
+using Poly = bitset<128>;
+
+int poly_degree(const Poly& p) {
+    for (int i = 127; i >= 0; --i)
+        if (p[i]) return i;
+    return -1;
+}
+
+Poly poly_mod(Poly a, const Poly& m) {
+    int dm = poly_degree(m);
+    for (int da = poly_degree(a); da >= dm; da = poly_degree(a))
+        a ^= m << (da - dm);
+    return a;
+}
+
+Poly poly_div(Poly a, const Poly& m) {
+    Poly quotient;
+    int dm = poly_degree(m);
+    for (int da = poly_degree(a); da >= dm; da = poly_degree(a)) {
+        quotient.set(da - dm);
+        a ^= m << (da - dm);
+    }
+    return quotient;
+}
+
+Poly poly_gcd(Poly a, Poly b) {
+    while (b.any()) {
+        a = poly_mod(a, b);
+        swap(a, b);
+    }
+    return a;
+}
+
+// a * b mod m (a, b już zredukowane modulo m)
+Poly poly_mul_mod(const Poly& a, const Poly& b, const Poly& m) {
+    int dm = poly_degree(m);
+    Poly result;
+    for (int i = poly_degree(b); i >= 0; --i) {
+        result <<= 1;
+        if (result[dm]) result ^= m;
+        if (b[i]) result ^= a;
+    }
+    return result;
+}
+
+// x^e mod m
+Poly poly_x_power(uint64_t e, const Poly& m) {
+    Poly result = poly_mod(Poly(1), m), base = poly_mod(Poly(2), m);
+    for (; e > 0; e >>= 1) {
+        if (e & 1) result = poly_mul_mod(result, base, m);
+        base = poly_mul_mod(base, base, m);
+    }
+    return result;
+}
+
+string poly_to_string(const Poly& p) {
+    string text;
+    for (int i = poly_degree(p); i >= 0; --i) {
+        if (!p[i]) continue;
+        if (!text.empty()) text += " + ";
+        text += i == 0 ? "1" : i == 1 ? "x" : "x^" + to_string(i);
+    }
+    return text.empty() ? "0" : text;
+}
+
+// Wielomian sprzężenia P(x) = x^n + SUMA_{p in taps} x^(n-1-p)
+Poly feedback_polynomial(int n, const vector<int>& feedback_positions) {
+    Poly p;
+    p.set(n);
+    for (int pos : feedback_positions)
+        p.flip(n - 1 - pos);
+    return p;
+}
+
+// Rząd x modulo m (m(0) = 1), gdy wiadomo, że dzieli on multiple:
+// od multiple usuwa się kolejne czynniki pierwsze, dopóki x^(e/q) = 1
+uint64_t order_dividing(const Poly& m, uint64_t multiple, const vector<uint64_t>& primes) {
+    uint64_t e = multiple;
+    Poly one = poly_mod(Poly(1), m);
+    for (uint64_t q : primes)
+        while (e % q == 0 && poly_x_power(e / q, m) == one)
+            e /= q;
+    return e;
+}
+
+// Test pierwotności: P(0) = 1 i rząd x modulo P równy 2^n - 1
+// (pierścień GF(2)[x]/P ma wtedy 2^n - 1 elementów odwracalnych, więc jest ciałem)
+// primes: czynniki pierwsze 2^n - 1 (przy wielu testach dla tego samego n liczone raz)
+bool is_primitive(const Poly& p, const vector<uint64_t>& primes) {
+    int n = poly_degree(p);
+    if (n < 1 || !p[0]) return false;
+    uint64_t period = n == 64 ? ~0ULL : (1ULL << n) - 1;
+    Poly one = poly_mod(Poly(1), p);
+    // x^(2^n) = x (n podniesień do kwadratu) jest tańsze niż x^(2^n - 1) = 1 i odsiewa
+    // większość kandydatów; przy P(0) = 1 oba warunki są równoważne
+    Poly x = poly_mod(Poly(2), p), power = x;
+    for (int i = 0; i < n; ++i)
+        power = poly_mul_mod(power, power, p);
+    if (power != x) return false;
+    for (uint64_t q : primes)
+        if (poly_x_power(period / q, p) == one) return false;
+    return true;
+}
+
+bool is_primitive(const Poly& p) {
+    int n = poly_degree(p);
+    return is_primitive(p, prime_factors(n == 64 ? ~0ULL : (1ULL << n) - 1));
+}
+
+// Okres ciągu o wielomianie minimalnym f = x^a * g, g(0) = 1: ciąg jest okresowy od
+// wyrazu a, a okres to rząd g. Rząd g liczony z rozkładu bezkwadratowego g = PROD h_i^(e_i)
+// i rozkładu h_i na iloczyny czynników nierozkładalnych równego stopnia d (rząd dzieli
+// 2^d - 1); wynik to NWW rzędów pomnożona przez 2^ceil(log2 max e_i).
+struct PeriodInfo {
+    uint64_t preperiod;
+    uint64_t period;
+    bool overflow;  // okres przekracza 2^64 - 1
+};
+
+PeriodInfo sequence_period(Poly f) {
+    PeriodInfo info = { 0, 1, false };
+    while (f.any() && !f[0]) {
+        f >>= 1;
+        ++info.preperiod;
+    }
+    if (poly_degree(f) <= 0)
+        return info;
+
+    // Rozkład bezkwadratowy: pary (czynnik bezkwadratowy, krotność)
+    vector<pair<Poly, uint64_t>> squarefree;
+    vector<pair<Poly, uint64_t>> work = { { f, 1 } };
+    while (!work.empty()) {
+        Poly g = work.back().first;
+        uint64_t multiplicity = work.back().second;
+        work.pop_back();
+        if (poly_degree(g) <= 0) continue;
+        Poly derivative;
+        for (int i = 1; i <= poly_degree(g); i += 2)
+            if (g[i]) derivative.set(i - 1);
+        if (derivative.none()) {
+            // g = h(x)^2: pierwiastek przez wybór współczynników parzystych
+            Poly root;
+            for (int i = 0; i <= poly_degree(g); i += 2)
+                if (g[i]) root.set(i / 2);
+            work.push_back({ root, multiplicity * 2 });
+            continue;
+        }
+        Poly c = poly_gcd(g, derivative);
+        Poly w = poly_div(g, c);
+        for (uint64_t i = 1; poly_degree(w) > 0; ++i) {
+            Poly y = poly_gcd(w, c);
+            Poly factor = poly_div(w, y);
+            if (poly_degree(factor) > 0)
+                squarefree.push_back({ factor, multiplicity * i });
+            w = y;
+            c = poly_div(c, y);
+        }
+        if (poly_degree(c) > 0)
+            work.push_back({ c, multiplicity });
+    }
+
+    uint64_t period = 1, max_multiplicity = 1;
+    for (auto& part : squarefree) {
+        max_multiplicity = max(max_multiplicity, part.second);
+        // Rozkład na stopnie: iloczyn czynników stopnia d = NWD(x^(2^d) - x, h)
+        Poly h = part.first;
+        Poly x_power = poly_mod(Poly(2), h);
+        for (int d = 1; poly_degree(h) > 0; ++d) {
+            if (2 * d > poly_degree(h)) {
+                d = poly_degree(h);  // reszta jest nierozkładalna
+                x_power = poly_mod(Poly(2), h);
+                for (int i = 0; i < d; ++i)
+                    x_power = poly_mul_mod(x_power, x_power, h);
+            }
+            else {
+                x_power = poly_mul_mod(x_power, x_power, h);
+            }
+            Poly g = poly_gcd(x_power ^ poly_mod(Poly(2), h), h);
+            if (poly_degree(g) > 0) {
+                uint64_t multiple = d == 64 ? ~0ULL : (1ULL << d) - 1;
+                uint64_t order = order_dividing(g, multiple, prime_factors(multiple));
+                uint64_t common = gcd64(period, order);
+                if (period / common > ~0ULL / order) info.overflow = true;
+                else period = period / common * order;
+                h = poly_div(h, g);
+                x_power = poly_mod(x_power, h);
+            }
+        }
+    }
+    int shift = 0;
+    while ((1ULL << shift) < max_multiplicity) ++shift;
+    if (shift > 0 && period > (~0ULL >> shift)) info.overflow = true;
+    else period <<= shift;
+    info.period = period;
+    return info;
+}
+
+// Algorytm Berlekampa-Masseya: wielomian minimalny ciągu bitów (postać charakterystyczna,
+// x^L * C(1/x)); wystarcza 2n bitów ciągu generowanego przez rejestr długości n
+Poly berlekamp_massey(const vector<int>& bits) {
+    Poly c(1), b(1);
+    int length = 0, m = 1;
+    for (size_t i = 0; i < bits.size(); ++i) {
+        int discrepancy = bits[i];
+        for (int j = 1; j <= length; ++j)
+            discrepancy ^= c[j] & bits[i - j];
+        if (discrepancy == 0) {
+            ++m;
+        }
+        else if (2 * length <= static_cast<int>(i)) {
+            Poly previous = c;
+            c ^= b << m;
+            length = static_cast<int>(i) + 1 - length;
+            b = previous;
+            m = 1;
+        }
+        else {
+            c ^= b << m;
+            ++m;
+        }
+    }
+    Poly characteristic;
+    for (int j = 0; j <= length; ++j)
+        if (c[j]) characteristic.set(length - j);
+    return characteristic;
+}
+
+// Tryb analizy: pierwotność P(x) i dokładny okres dla podanego stanu początkowego
+void analyze_feedback(const vector<int>& initial_state, const vector<int>& feedback_positions,
+    ostream& report) {
+    int n = static_cast<int>(initial_state.size());
+    Poly p = feedback_polynomial(n, feedback_positions);
+    bool primitive = is_primitive(p);
+    report << "Wielomian: " << poly_to_string(p) << "\n"
+        << "Pierwotny: " << (primitive ? "tak" : "nie") << "\n";
+    if (primitive) {
+        report << "Okres: " << (n == 64 ? ~0ULL : (1ULL << n) - 1) << " (maksymalny)\n";
+        return;
+    }
+
+    PackedLFSR lfsr(initial_state, feedback_positions);
+    vector<int> bits(2 * n);
+    for (int& bit : bits)
+        bit = lfsr.step();
+    Poly minimal = berlekamp_massey(bits);
+    PeriodInfo info = sequence_period(minimal);
+    PeriodInfo register_info = sequence_period(p);
+    report << "Wielomian minimalny ciagu: " << poly_to_string(minimal) << "\n";
+    if (info.overflow) report << "Okres: > 2^64\n";
+    else report << "Okres: " << info.period << "\n";
+    report << "Przedokres: " << info.preperiod << "\n";
+    if (register_info.overflow) report << "Maksymalny okres rejestru: > 2^64\n";
+    else report << "Maksymalny okres rejestru: " << register_info.period << "\n";
+}
+
+// ---------------------------------------------------------------------------------------
+// Wsadowe wyszukiwanie konfiguracji tapów o maksymalnym okresie
+// ---------------------------------------------------------------------------------------
+
+// Kandydaci z pliku: każda niepusta linia to pozycje tapów w formacie jak w input.txt
+vector<uint64_t> read_tap_candidates(const string& filename, int n) {
+    ifstream infile(filename);
+    if (!infile.is_open())
+        throw runtime_error("Nie mozna otworzyc pliku " + filename);
+    vector<uint64_t> candidates;
+    string line;
+    while (getline(infile, line)) {
+        istringstream line_stream(line);
+        uint64_t mask = 0;
+        int tap;
+        while (line_stream >> tap) {
+            if (tap < 0 || tap >= n)
+                throw out_of_range("Nieprawidlowa pozycja tapu: " + to_string(tap));
+            mask |= 1ULL << tap;
+        }
+        if (mask != 0)
+            candidates.push_back(mask);
+    }
+    return candidates;
+}
+
+// Kandydaci wyliczeni: wszystkie zbiory od min_taps do max_taps tapów zawierające tap n-1
+// (bez niego P(0) = 0 i wielomian nie jest pierwotny). Dla n > 1 pomijane są nieparzyste
+// liczby tapów: P(x) ma wtedy parzystą liczbę składników, więc dzieli się przez x + 1.
+vector<uint64_t> enumerate_tap_candidates(int n, int min_taps, int max_taps) {
+    vector<uint64_t> candidates;
+    uint64_t top = 1ULL << (n - 1);
+    for (int k = max(1, min_taps); k <= min(n, max_taps); ++k) {
+        if (n > 1 && k % 2 == 1) continue;
+        // Kolejne (k-1)-elementowe podzbiory pozycji 0..n-2 (następnik Gospera)
+        int rest = k - 1;
+        if (rest == 0) {
+            candidates.push_back(top);
+            continue;
+        }
+        uint64_t limit = top;  // podzbiory muszą mieścić się poniżej bitu n-1
+        for (uint64_t mask = (1ULL << rest) - 1; mask < limit;) {
+            candidates.push_back(top | mask);
+            uint64_t low = mask & (~mask + 1);
+            uint64_t ripple = mask + low;
+            if (ripple == 0) break;
+            mask = ripple | (((mask ^ ripple) >> 2) / low);
+        }
+    }
+    return candidates;
+}
+
+// Test pierwotności wszystkich kandydatów w puli wątków; wyniki w kolejności liczby tapów
+void run_tap_search(int n, const vector<uint64_t>& candidates, unsigned threads, ostream& report) {
+    vector<uint64_t> primes = prime_factors(n == 64 ? ~0ULL : (1ULL << n) - 1);
+    vector<char> primitive(candidates.size(), 0);
+    atomic<size_t> next_candidate(0);
+    auto worker = [&]() {
+        for (size_t i = next_candidate++; i < candidates.size(); i = next_candidate++) {
+            vector<int> taps;
+            for (int pos = 0; pos < n; ++pos)
+                if ((candidates[i] >> pos) & 1)
+                    taps.push_back(pos);
+            primitive[i] = is_primitive(feedback_polynomial(n, taps), primes);
+        }
+    };
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (thread& t : pool)
+        t.join();
+
+    vector<uint64_t> found;
+    for (size_t i = 0; i < candidates.size(); ++i)
+        if (primitive[i])
+            found.push_back(candidates[i]);
+    // Ranking: najmniej tapów najpierw, przy remisie tapy od najwyższej pozycji
+    sort(found.begin(), found.end(), [](uint64_t x, uint64_t y) {
+        int cx = popcount64(x), cy = popcount64(y);
+        return cx != cy ? cx < cy : x > y;
+    });
+    found.erase(unique(found.begin(), found.end()), found.end());
+
+    report << "Kandydaci: " << candidates.size() << "\n"
+        << "Konfiguracje o maksymalnym okresie: " << found.size() << "\n";
+    for (uint64_t mask : found) {
+        report << popcount64(mask) << ":";
+        for (int pos = n - 1; pos >= 0; --pos)
+            if ((mask >> pos) & 1)
+                report << " " << pos;
+        report << "\n";
+    }
+}
+
+// Tryby: Lab4 (skok o 64 bity), Lab4 --packed (krok po bicie na upakowanym stanie),
+// Lab4 --slow (ścieżka referencyjna), Lab4 --threads T (segmenty równoległe z przeskokiem),
+// --validate (porównanie statystyk i skrótu z referencyjną), --length L (tylko L bitów).
+// Lab4 --analyze: test pierwotności wielomianu sprzężenia i okres, bez generowania ciągu.
+// Lab4 --search plik | --search-taps kmin kmax [--threads T]: wsadowe wyszukiwanie tapów
+// o maksymalnym okresie dla n z input.txt (kandydaci z pliku lub wszystkie zbiory kmin..kmax).
+// Ciąg trafia do output.bin (słowa 64-bitowe), podsumowanie do output.csv.
+int main(int argc, char* argv[]) {
     try {
+        bool slow = false, packed = false, validate = false, analyze = false;
+        string search_file;
+        int search_min_taps = 0, search_max_taps = 0;
+        unsigned threads = 0;
+        uint64_t requested_length = 0;
+        for (int i = 1; i < argc; ++i) {
+            string arg = argv[i];
+            if (arg == "--slow") slow = true;
+            else if (arg == "--threads" && i + 1 < argc) {
+                int value = stoi(argv[++i]);
+                threads = value > 0 ? static_cast<unsigned>(value) : max(1u, thread::hardware_concurrency());
+            }
+            else if (arg == "--packed") packed = true;
+            else if (arg == "--analyze") analyze = true;
+            else if (arg == "--search" && i + 1 < argc) search_file = argv[++i];
+            else if (arg == "--search-taps" && i + 2 < argc) {
+                search_min_taps = stoi(argv[++i]);
+                search_max_taps = stoi(argv[++i]);
+                if (search_min_taps <= 0 || search_max_taps < search_min_taps)
+                    throw invalid_argument("Nieprawidlowy zakres liczby tapow");
+            }
+            else if (arg == "--length" && i + 1 < argc) requested_length = stoull(argv[++i]);
+            else if (arg == "--validate") validate = true;
+            else throw invalid_argument("Nieznana opcja: " + arg);
+        }
+
         ifstream infile("input.txt");
         if (!infile.is_open())
             throw runtime_error("Nie mozna otworzyc pliku input.txt");
@@ -96,41 +948,85 @@ int main() {
         if (feedback_positions.empty())
             throw invalid_argument("Brak poprawnych pozycji sprzezenia zwrotnego");
 
-        // Reszta kodu bez zmian
-        uint64_t max_length = (1ULL << n) - 1;
-        vector<int> state = initial_state;
-        vector<int> sequence;
-        sequence.reserve(max_length);
+        if (!search_file.empty() || search_max_taps > 0) {
+            auto t_start = chrono::high_resolution_clock::now();
+            vector<uint64_t> candidates = search_file.empty()
+                ? enumerate_tap_candidates(n, search_min_taps, search_max_taps)
+                : read_tap_candidates(search_file, n);
+            ostringstream report;
+            run_tap_search(n, candidates, max(1u, threads), report);
+            auto duration = chrono::duration_cast<chrono::nanoseconds>(
+                chrono::high_resolution_clock::now() - t_start);
+            report << "Czas: " << duration.count() << " ns\n";
 
-        auto t_start = chrono::high_resolution_clock::now();
+            ofstream outfile("output.csv");
+            if (!outfile.is_open())
+                throw runtime_error("Nie mozna otworzyc pliku output.csv");
+            outfile << report.str();
+            cout << "Wyszukiwanie zakonczone: " << candidates.size() << " kandydatow, wyniki w output.csv\n";
+            return 0;
+        }
 
-        for (uint64_t i = 0; i < max_length; ++i) {
-            int output_bit = state.back();
-            sequence.push_back(output_bit);
+        if (analyze) {
+            auto t_start = chrono::high_resolution_clock::now();
+            ostringstream report;
+            analyze_feedback(initial_state, feedback_positions, report);
+            auto duration = chrono::duration_cast<chrono::nanoseconds>(
+                chrono::high_resolution_clock::now() - t_start);
+            report << "Czas: " << duration.count() << " ns\n";
 
-            int feedback = xor_mod2(state, feedback_positions);
-            for (int j = n - 1; j > 0; --j) {
-                state[j] = state[j - 1];
-            }
-            state[0] = feedback;
+            ofstream outfile("output.csv");
+            if (!outfile.is_open())
+                throw runtime_error("Nie mozna otworzyc pliku output.csv");
+            outfile << report.str();
+            cout << report.str();
+            return 0;
         }
 
+        uint64_t max_length = n == 64 ? ~0ULL : (1ULL << n) - 1;
+        if (requested_length > 0)
+            max_length = requested_length;
+
+        SequenceSink sink;
+        auto t_start = chrono::high_resolution_clock::now();
+        {
+            PackedBitWriter writer("output.bin");
+            sink.writer = &writer;
+            if (slow)
+                generate_reference(initial_state, feedback_positions, max_length, sink);
+            else if (threads > 0)
+                generate_parallel(initial_state, feedback_positions, max_length, threads, sink);
+            else if (packed)
+                generate_packed(initial_state, feedback_positions, max_length, sink);
+            else
+                generate_leap(initial_state, feedback_positions, max_length, sink);
+            sink.writer = nullptr;
+        }
         auto t_end = chrono::high_resolution_clock::now();
         auto duration = chrono::duration_cast<chrono::nanoseconds>(t_end - t_start);
+        const SequenceStats& stats = sink.stats;
+
+        if (validate) {
+            SequenceSink reference;
+            generate_reference(initial_state, feedback_positions, max_length, reference);
+            if (!(reference.stats == stats))
+                throw runtime_error("Walidacja nieudana: wybrana sciezka rozni sie od referencyjnej");
+            cout << "Walidacja: sekwencja zgodna ze sciezka referencyjna.\n";
+        }
 
-        double entropy = calculate_entropy(sequence);
+        double entropy = calculate_entropy(stats.length - stats.ones, stats.ones);
 
         ofstream outfile("output.csv");
         if (!outfile.is_open())
             throw runtime_error("Nie mozna otworzyc pliku output.csv");
 
-        outfile << "Dlugosc: " << sequence.size() << "\n"
+        outfile << "Dlugosc: " << stats.length << "\n"
             << "Entropia: " << entropy << "\n"
-            << "Czas: " << duration.count() << " ns\n";
-
-        for (int b : sequence) {
-            outfile << b << "\n";
-        }
+            << "Czas: " << duration.count() << " ns\n"
+            << "Jedynki: " << stats.ones << "\n"
+            << "Zera: " << stats.length - stats.ones << "\n"
+            << "Serie: " << stats.runs << "\n"
+            << "Plik z ciagiem: output.bin\n";
 
         cout << "Generowanie zakonczone pomyslnie!\n";
     }